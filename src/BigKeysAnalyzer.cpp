@@ -0,0 +1,352 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "BigKeysAnalyzer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+#include "Hash.h"
+
+namespace redisCliCs
+{
+
+/// Resolution of the sampling decision.
+#define BIG_KEYS_SAMPLE_RESOLUTION 1000000ULL
+
+namespace
+{
+
+/// Quotes a prefix group, except the groups of the keys which don't have a prefix.
+std::string FormatPrefix(const std::string& prefix)
+{
+    if (prefix == BIG_KEYS_OTHER_PREFIX || prefix == BIG_KEYS_NO_PREFIX)
+        return prefix;
+    return BigKeysAnalyzer::FormatKey(prefix);
+}
+
+/// Orders the prefix groups by memory usage, the biggest first.
+bool PrefixBytesGreater(const std::pair<std::string, BigKeysPrefixStats>& a,
+                        const std::pair<std::string, BigKeysPrefixStats>& b)
+{
+    return a.second.totalBytes > b.second.totalBytes;
+}
+
+}
+
+BigKeysAnalyzer::BigKeysAnalyzer(const RedisConnectionString& cs, const BigKeysOptions& options) :
+    _cs(cs),
+    _options(options),
+    _scanner(),
+    _workers()
+{
+    _options.connections = std::max<std::size_t>(1, std::min<std::size_t>(_options.connections, BIG_KEYS_MAX_CONNECTIONS));
+    _options.topK = std::min<std::size_t>(_options.topK, BIG_KEYS_MAX_TOP_K);
+    _options.scanCount = std::max<std::size_t>(1, std::min<std::size_t>(_options.scanCount, BIG_KEYS_MAX_SCAN_COUNT));
+    _options.maxPrefixes = std::min<std::size_t>(_options.maxPrefixes, BIG_KEYS_MAX_PREFIXES);
+}
+
+BigKeysAnalyzer::~BigKeysAnalyzer()
+{
+    for (std::vector<RedisConnection*>::iterator itr = _workers.begin(); itr != _workers.end(); ++itr)
+        delete *itr;
+}
+
+void BigKeysAnalyzer::Run(std::ostream& out)
+{
+    _scanner.Connect(_cs);
+    while (_workers.size() < _options.connections)
+    {
+        _workers.push_back(new RedisConnection());
+        _workers.back()->Connect(_cs);
+    }
+
+    std::vector<int> dbs;
+    // The path of the connection string selects one DB.
+    if (_cs.HasDb())
+        dbs.push_back(_cs.GetDb());
+    else
+        dbs = GetDbIndexes();
+
+    if (dbs.empty())
+        out << "No keys found." << std::endl;
+
+    for (std::vector<int>::const_iterator itr = dbs.begin(); itr != dbs.end(); ++itr)
+    {
+        BigKeysStats stats(_options.topK, _options.prefixDelimiter, _options.maxPrefixes);
+        unsigned long long scanned = 0;
+        AnalyzeDb(*itr, stats, scanned);
+        Report(*itr, stats, scanned, _options.sampleRate, out);
+    }
+}
+
+bool BigKeysAnalyzer::IsSampled(const std::string& key, double sampleRate)
+{
+    if (sampleRate >= 1.0)
+        return true;
+
+    return Fnv1a64(key) % BIG_KEYS_SAMPLE_RESOLUTION < sampleRate * BIG_KEYS_SAMPLE_RESOLUTION;
+}
+
+std::string BigKeysAnalyzer::FormatBytes(unsigned long long bytes)
+{
+    static const char* units[] = { "B", "K", "M", "G", "T", "P" };
+
+    std::ostringstream ss;
+    if (bytes < 1024)
+    {
+        ss << bytes << units[0];
+        return ss.str();
+    }
+
+    double value = static_cast<double>(bytes);
+    std::size_t unit = 0;
+    while (value >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0]))
+    {
+        value /= 1024;
+        ++unit;
+    }
+    ss << std::fixed << std::setprecision(1) << value << units[unit];
+    return ss.str();
+}
+
+std::string BigKeysAnalyzer::FormatKey(const std::string& key)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    std::string quoted = "\"";
+    for (std::string::const_iterator itr = key.begin(); itr != key.end(); ++itr)
+    {
+        unsigned char c = static_cast<unsigned char>(*itr);
+        switch (c)
+        {
+            case '\\': quoted += "\\\\"; break;
+            case '"':  quoted += "\\\""; break;
+            case '\n': quoted += "\\n"; break;
+            case '\r': quoted += "\\r"; break;
+            case '\t': quoted += "\\t"; break;
+            case '\a': quoted += "\\a"; break;
+            case '\b': quoted += "\\b"; break;
+            default:
+                if (std::isprint(c))
+                    quoted += *itr;
+                else
+                {
+                    quoted += "\\x";
+                    quoted += hexDigits[c >> 4];
+                    quoted += hexDigits[c & 0xf];
+                }
+                break;
+        }
+    }
+    return quoted + "\"";
+}
+
+std::vector<int> BigKeysAnalyzer::GetDbIndexes()
+{
+    RedisReply reply = _scanner.Command(RedisCommand("INFO") << "keyspace");
+    if (reply.IsError())
+        throw RedisConnection::ReplyErrorException(reply.GetString());
+    return ParseDbIndexes(reply.GetString());
+}
+
+std::vector<int> BigKeysAnalyzer::ParseDbIndexes(const std::string& info)
+{
+    std::vector<int> dbs;
+    std::istringstream lines(info);
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        if (line.compare(0, 2, "db") != 0)
+            continue;
+        std::size_t separatorPos = line.find(':');
+        if (separatorPos == std::string::npos)
+            continue;
+        dbs.push_back(std::atoi(line.substr(2, separatorPos - 2).c_str()));
+    }
+    return dbs;
+}
+
+void BigKeysAnalyzer::GetChunk(std::size_t keyCount, std::size_t workerCount, std::size_t worker,
+                               std::size_t& begin, std::size_t& end)
+{
+    std::size_t chunkSize = (keyCount + workerCount - 1) / workerCount;
+    begin = std::min(worker * chunkSize, keyCount);
+    end = std::min(begin + chunkSize, keyCount);
+}
+
+bool BigKeysAnalyzer::AddKey(const std::string& key, const RedisReply& type, const RedisReply& usage, BigKeysStats& stats)
+{
+    if (type.IsError())
+        throw RedisConnection::ReplyErrorException(type.GetString());
+    if (usage.IsError())
+        throw RedisConnection::ReplyErrorException(usage.GetString());
+    // The key was deleted since SCAN returned it.
+    if (type.GetString() == "none" || usage.IsNil())
+        return false;
+    stats.Add(key, type.GetString(), usage.GetInteger());
+    return true;
+}
+
+void BigKeysAnalyzer::AnalyzeDb(int db, BigKeysStats& stats, unsigned long long& scanned)
+{
+    _scanner.Select(db);
+    for (std::vector<RedisConnection*>::iterator itr = _workers.begin(); itr != _workers.end(); ++itr)
+        (*itr)->Select(db);
+
+    long long scanCount = static_cast<long long>(_options.scanCount);
+    _scanner.AppendCommand(RedisCommand("SCAN") << "0" << "COUNT" << scanCount);
+    _scanner.Flush();
+
+    std::vector<std::string> keys;
+    for (;;)
+    {
+        RedisReply reply = _scanner.ReadReply();
+        if (reply.IsError())
+            throw RedisConnection::ReplyErrorException(reply.GetString());
+        if (reply.GetType() != RedisReply::REPLY_ARRAY || reply.GetElements().size() != 2)
+            throw RedisConnection::ProtocolException("unexpected SCAN reply");
+
+        // Requests the next page before the current one is analyzed,
+        // so the server works on it in the meantime.
+        std::string cursor = reply.GetElements()[0].GetString();
+        bool done = cursor == "0";
+        if (!done)
+        {
+            _scanner.AppendCommand(RedisCommand("SCAN") << cursor << "COUNT" << scanCount);
+            _scanner.Flush();
+        }
+
+        keys.clear();
+        const std::vector<RedisReply>& page = reply.GetElements()[1].GetElements();
+        for (std::vector<RedisReply>::const_iterator itr = page.begin(); itr != page.end(); ++itr)
+        {
+            ++scanned;
+            if (IsSampled(itr->GetString(), _options.sampleRate))
+                keys.push_back(itr->GetString());
+        }
+        if (!keys.empty())
+            AnalyzeBatch(keys, stats);
+
+        if (done)
+            break;
+    }
+}
+
+void BigKeysAnalyzer::AnalyzeBatch(const std::vector<std::string>& keys, BigKeysStats& stats)
+{
+    // Sends every worker its chunk in one write first...
+    for (std::size_t w = 0; w < _workers.size(); ++w)
+    {
+        std::size_t begin, end;
+        GetChunk(keys.size(), _workers.size(), w, begin, end);
+        if (begin == end)
+            break;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            _workers[w]->AppendCommand(RedisCommand("TYPE") << keys[i]);
+            _workers[w]->AppendCommand(RedisCommand("MEMORY") << "USAGE" << keys[i]);
+        }
+        _workers[w]->Flush();
+    }
+
+    // ...then collects the replies, so the round trips overlap.
+    for (std::size_t w = 0; w < _workers.size(); ++w)
+    {
+        std::size_t begin, end;
+        GetChunk(keys.size(), _workers.size(), w, begin, end);
+        if (begin == end)
+            break;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            RedisReply type = _workers[w]->ReadReply();
+            RedisReply usage = _workers[w]->ReadReply();
+            AddKey(keys[i], type, usage, stats);
+        }
+    }
+}
+
+void BigKeysAnalyzer::Report(int db, const BigKeysStats& stats, unsigned long long scanned, double sampleRate, std::ostream& out)
+{
+    out << "# DB " << db << std::endl;
+    out << "Scanned keys: " << scanned
+        << ", analyzed keys: " << stats.GetKeyCount()
+        << ", memory usage: " << FormatBytes(stats.GetTotalBytes()) << std::endl;
+    if (sampleRate < 1.0)
+        out << "Sample rate: " << sampleRate
+            << " (the counts and the memory usage cover only the sampled keys)" << std::endl;
+
+    for (std::size_t t = 0; t < BigKeysStats::KEY_TYPE_COUNT; ++t)
+    {
+        BigKeysStats::KeyType type = static_cast<BigKeysStats::KeyType>(t);
+        const BigKeysTypeStats& typeStats = stats.GetTypeStats(type);
+        if (!typeStats.count)
+            continue;
+
+        out << std::endl << "## " << BigKeysStats::GetKeyTypeName(type) << ": "
+            << typeStats.count << " keys, "
+            << FormatBytes(typeStats.totalBytes) << " total, "
+            << FormatBytes(typeStats.totalBytes / typeStats.count) << " average" << std::endl;
+
+        std::vector<BigKey> topKeys = stats.GetTopKeys(type);
+        if (!topKeys.empty())
+        {
+            out << "Biggest keys:" << std::endl;
+            for (std::size_t i = 0; i < topKeys.size(); ++i)
+                out << "  " << std::setw(3) << i + 1 << ") " << std::setw(8) << FormatBytes(topKeys[i].bytes)
+                    << "  " << FormatKey(topKeys[i].name) << std::endl;
+        }
+
+        out << "Size histogram:" << std::endl;
+        for (std::size_t bucket = 0; bucket < BIG_KEYS_HISTOGRAM_BUCKETS; ++bucket)
+        {
+            if (!typeStats.histogram[bucket])
+                continue;
+            // Bucket 0 also holds the empty keys.
+            std::string range = "[" + FormatBytes(bucket ? 1ULL << bucket : 0) + ", " +
+                (bucket + 1 < BIG_KEYS_HISTOGRAM_BUCKETS ? FormatBytes(1ULL << (bucket + 1)) : std::string("inf")) + ")";
+            out << "  " << std::left << std::setw(16) << range << std::right
+                << std::setw(12) << typeStats.histogram[bucket] << std::endl;
+        }
+    }
+
+    const std::map<std::string, BigKeysPrefixStats>& prefixMap = stats.GetPrefixStats();
+    if (!prefixMap.empty())
+    {
+        std::vector<std::pair<std::string, BigKeysPrefixStats> > prefixes(prefixMap.begin(), prefixMap.end());
+        std::sort(prefixes.begin(), prefixes.end(), PrefixBytesGreater);
+
+        out << std::endl << "## Key prefixes" << std::endl;
+        for (std::size_t i = 0; i < prefixes.size(); ++i)
+            out << "  " << std::setw(8) << FormatBytes(prefixes[i].second.totalBytes)
+                << std::setw(12) << prefixes[i].second.count << " keys  "
+                << FormatPrefix(prefixes[i].first) << std::endl;
+    }
+    out << std::endl;
+}
+
+}
@@ -0,0 +1,196 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "BigKeysStats.h"
+#include "RedisConnection.h"
+#include "RedisConnectionString.h"
+
+namespace redisCliCs
+{
+
+/// Upper limit of BigKeysOptions::connections.
+#define BIG_KEYS_MAX_CONNECTIONS 64
+/// Upper limit of BigKeysOptions::topK, the heaps are reserved up front.
+#define BIG_KEYS_MAX_TOP_K 10000
+/// Upper limit of BigKeysOptions::scanCount, a batch is this big.
+#define BIG_KEYS_MAX_SCAN_COUNT 100000
+/// Upper limit of BigKeysOptions::maxPrefixes.
+#define BIG_KEYS_MAX_PREFIXES 1000000
+
+/**
+ * @brief Options of the big keys analyzer.
+ */
+struct BigKeysOptions
+{
+    BigKeysOptions() : connections(4),
+                       topK(10),
+                       scanCount(1000),
+                       sampleRate(1.0),
+                       prefixDelimiter(""),
+                       maxPrefixes(1024) {}
+
+    /// Number of the connections which run the TYPE and MEMORY USAGE commands.
+    std::size_t connections;
+    /// How many of the biggest keys are reported per type.
+    std::size_t topK;
+    /// COUNT hint of the SCAN command.
+    std::size_t scanCount;
+    /// Ratio of the keys which are analyzed, in (0, 1].
+    double sampleRate;
+    /// Delimiter of the key prefix groups, empty string disables the grouping.
+    std::string prefixDelimiter;
+    /// Maximum number of the key prefix groups.
+    std::size_t maxPrefixes;
+};
+
+/**
+ * @brief Finds the biggest keys and profiles the memory usage of a Redis server.
+ *
+ * One connection iterates the keyspace with SCAN, while the keys of the previous
+ * SCAN reply are split between the worker connections, which get their
+ * TYPE and MEMORY USAGE commands in a single pipelined batch.
+ * The next SCAN is already sent while the batch is processed.
+ *
+ * The connections are driven from one thread. Redis executes the commands on
+ * a single thread, so the speedup comes from overlapping the round trips,
+ * which the pipelines on several sockets already give, without locking the stats.
+ */
+class BigKeysAnalyzer
+{
+public:
+    /**
+     * @param cs      Connection string of the Redis server. If it has a path only
+     *                that DB is analyzed, otherwise all the DBs which have keys.
+     * @param options Options, the counts are clamped to their BIG_KEYS_MAX_* limits.
+     */
+    BigKeysAnalyzer(const RedisConnectionString& cs, const BigKeysOptions& options);
+    ~BigKeysAnalyzer();
+
+    /**
+     * @brief Analyzes the DBs and writes the report.
+     *
+     * @param out Output of the report.
+     *
+     * @throws RedisConnection::ConnectionException  When a connection fails.
+     * @throws RedisConnection::ProtocolException    When a reply is malformed.
+     * @throws RedisConnection::ReplyErrorException  When a command fails.
+     */
+    void Run(std::ostream& out);
+
+    /**
+     * @brief Decides whether a key is in the sample. The decision only depends
+     *        on the key, so repeated runs analyze the same keys.
+     *
+     * @param key        Name of the key.
+     * @param sampleRate Ratio of the keys which are in the sample, in (0, 1].
+     * @return           True if the key has to be analyzed.
+     */
+    static bool IsSampled(const std::string& key, double sampleRate);
+    /**
+     * @brief Formats a size in human readable form, like 1.5K.
+     */
+    static std::string FormatBytes(unsigned long long bytes);
+    /**
+     * @brief Quotes a key name for the report like redis-cli does: ", \\ and
+     *        the common control characters are escaped with \\, the other
+     *        not printable bytes are written as \\xHH.
+     */
+    static std::string FormatKey(const std::string& key);
+    /**
+     * @brief Gets the indexes of the DBs which have keys.
+     *
+     * @param info The keyspace section of INFO, its lines look like db0:keys=1,expires=0,avg_ttl=0.
+     * @return     The DB indexes in the order of the lines.
+     */
+    static std::vector<int> ParseDbIndexes(const std::string& info);
+    /**
+     * @brief Gets the keys of a worker when a batch is split between the workers.
+     *        The chunks are equal, except the last ones, which may be shorter or empty.
+     *
+     * @param keyCount    Number of the keys in the batch.
+     * @param workerCount Number of the workers.
+     * @param worker      Index of the worker.
+     * @param begin       Index of the first key of the worker.
+     * @param end         Index after the last key of the worker, equals to begin if it has no keys.
+     */
+    static void GetChunk(std::size_t keyCount, std::size_t workerCount, std::size_t worker,
+                         std::size_t& begin, std::size_t& end);
+    /**
+     * @brief Adds a key to the statistics from its TYPE and MEMORY USAGE replies,
+     *        skips it if it was deleted since SCAN returned it.
+     *
+     * @return True if the key is added.
+     *
+     * @throws RedisConnection::ReplyErrorException When a reply is an error.
+     */
+    static bool AddKey(const std::string& key, const RedisReply& type, const RedisReply& usage, BigKeysStats& stats);
+    /**
+     * @brief Writes the report of a DB.
+     *
+     * @param db         Index of the DB.
+     * @param stats      Statistics of the DB.
+     * @param scanned    Number of the scanned keys, including the not sampled ones.
+     * @param sampleRate Ratio of the keys which were analyzed.
+     * @param out        Output of the report.
+     */
+    static void Report(int db, const BigKeysStats& stats, unsigned long long scanned, double sampleRate, std::ostream& out);
+
+private:
+    BigKeysAnalyzer(const BigKeysAnalyzer&);
+    BigKeysAnalyzer& operator=(const BigKeysAnalyzer&);
+
+    /**
+     * @brief Gets the indexes of the DBs which have keys with INFO keyspace.
+     */
+    std::vector<int> GetDbIndexes();
+    /**
+     * @brief Scans and analyzes a DB.
+     *
+     * @param db      Index of the DB.
+     * @param stats   Statistics of the DB.
+     * @param scanned Number of the scanned keys, including the not sampled ones.
+     */
+    void AnalyzeDb(int db, BigKeysStats& stats, unsigned long long& scanned);
+    /**
+     * @brief Gets the type and the memory usage of a batch of keys with the workers.
+     */
+    void AnalyzeBatch(const std::vector<std::string>& keys, BigKeysStats& stats);
+
+    /// Connection string of the Redis server.
+    RedisConnectionString _cs;
+    /// Options.
+    BigKeysOptions _options;
+    /// The connection which runs SCAN.
+    RedisConnection _scanner;
+    /// The connections which run TYPE and MEMORY USAGE.
+    std::vector<RedisConnection*> _workers;
+};
+
+}
@@ -0,0 +1,169 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "BigKeysStats.h"
+
+#include <algorithm>
+
+namespace redisCliCs
+{
+
+namespace
+{
+
+/// Orders the keys so the heap algorithms build a min-heap (smallest key at the front).
+struct BigKeyGreater
+{
+    bool operator()(const BigKey& a, const BigKey& b) const
+    {
+        return a.bytes > b.bytes;
+    }
+};
+
+}
+
+BigKeysStats::BigKeysStats(std::size_t topK, const std::string& prefixDelimiter, std::size_t maxPrefixes) :
+    _topK(topK),
+    _prefixDelimiter(prefixDelimiter),
+    _maxPrefixes(maxPrefixes),
+    _prefixes()
+{
+    for (std::size_t i = 0; i < KEY_TYPE_COUNT; ++i)
+        _types[i].topKeys.reserve(_topK);
+}
+
+void BigKeysStats::Add(const std::string& key, const std::string& typeName, unsigned long long bytes)
+{
+    BigKeysTypeStats& stats = _types[GetKeyType(typeName)];
+    ++stats.count;
+    stats.totalBytes += bytes;
+    ++stats.histogram[GetHistogramBucket(bytes)];
+
+    // Keeps the top K keys: the heap's front is the smallest kept key,
+    // it is only replaced by a bigger one once the heap is full.
+    if (_topK)
+    {
+        std::vector<BigKey>& heap = stats.topKeys;
+        if (heap.size() < _topK)
+        {
+            heap.push_back(BigKey(key, bytes));
+            std::push_heap(heap.begin(), heap.end(), BigKeyGreater());
+        }
+        else if (bytes > heap.front().bytes)
+        {
+            std::pop_heap(heap.begin(), heap.end(), BigKeyGreater());
+            heap.back() = BigKey(key, bytes);
+            std::push_heap(heap.begin(), heap.end(), BigKeyGreater());
+        }
+    }
+
+    if (!_prefixDelimiter.empty())
+    {
+        std::string prefix = GetPrefix(key);
+        std::map<std::string, BigKeysPrefixStats>::iterator itr = _prefixes.find(prefix);
+        if (itr == _prefixes.end())
+        {
+            // Too many groups, so the new prefixes are collected in one group.
+            // One slot is reserved for it.
+            if (_prefixes.size() + 1 >= _maxPrefixes)
+                prefix = BIG_KEYS_OTHER_PREFIX;
+            itr = _prefixes.insert(std::make_pair(prefix, BigKeysPrefixStats())).first;
+        }
+        ++itr->second.count;
+        itr->second.totalBytes += bytes;
+    }
+}
+
+unsigned long long BigKeysStats::GetKeyCount() const
+{
+    unsigned long long count = 0;
+    for (std::size_t i = 0; i < KEY_TYPE_COUNT; ++i)
+        count += _types[i].count;
+    return count;
+}
+
+unsigned long long BigKeysStats::GetTotalBytes() const
+{
+    unsigned long long bytes = 0;
+    for (std::size_t i = 0; i < KEY_TYPE_COUNT; ++i)
+        bytes += _types[i].totalBytes;
+    return bytes;
+}
+
+std::vector<BigKey> BigKeysStats::GetTopKeys(KeyType type) const
+{
+    std::vector<BigKey> keys = _types[type].topKeys;
+    // Sorting a min-heap with the same comparator gives descending order.
+    std::sort_heap(keys.begin(), keys.end(), BigKeyGreater());
+    return keys;
+}
+
+BigKeysStats::KeyType BigKeysStats::GetKeyType(const std::string& typeName)
+{
+    if (typeName == "string")
+        return KEY_TYPE_STRING;
+    if (typeName == "list")
+        return KEY_TYPE_LIST;
+    if (typeName == "set")
+        return KEY_TYPE_SET;
+    if (typeName == "zset")
+        return KEY_TYPE_ZSET;
+    if (typeName == "hash")
+        return KEY_TYPE_HASH;
+    if (typeName == "stream")
+        return KEY_TYPE_STREAM;
+    return KEY_TYPE_OTHER;
+}
+
+const char* BigKeysStats::GetKeyTypeName(KeyType type)
+{
+    switch (type)
+    {
+        case KEY_TYPE_STRING: return "string";
+        case KEY_TYPE_LIST:   return "list";
+        case KEY_TYPE_SET:    return "set";
+        case KEY_TYPE_ZSET:   return "zset";
+        case KEY_TYPE_HASH:   return "hash";
+        case KEY_TYPE_STREAM: return "stream";
+        default:              return "other";
+    }
+}
+
+std::size_t BigKeysStats::GetHistogramBucket(unsigned long long bytes)
+{
+    std::size_t bucket = 0;
+    while (bytes >>= 1)
+        ++bucket;
+    return bucket;
+}
+
+std::string BigKeysStats::GetPrefix(const std::string& key) const
+{
+    std::size_t delimiterPos = key.find(_prefixDelimiter);
+    if (delimiterPos == std::string::npos)
+        return BIG_KEYS_NO_PREFIX;
+    return key.substr(0, delimiterPos + _prefixDelimiter.length()) + "*";
+}
+
+}
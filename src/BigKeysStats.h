@@ -0,0 +1,175 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace redisCliCs
+{
+
+/// Number of the log2 scale size histogram buckets, bucket i counts the sizes in [2^i, 2^(i+1)).
+#define BIG_KEYS_HISTOGRAM_BUCKETS 64
+/// Name of the prefix group which collects the keys when there are too many prefix groups.
+#define BIG_KEYS_OTHER_PREFIX "(other)"
+/// Name of the prefix group which collects the keys without the prefix delimiter.
+#define BIG_KEYS_NO_PREFIX "(no prefix)"
+
+/**
+ * @brief A key and its memory usage.
+ */
+struct BigKey
+{
+    BigKey() : name(""), bytes(0) {}
+    BigKey(const std::string& keyName, unsigned long long keyBytes) : name(keyName), bytes(keyBytes) {}
+
+    /// Name of the key.
+    std::string name;
+    /// Memory usage of the key in bytes.
+    unsigned long long bytes;
+};
+
+/**
+ * @brief Aggregated statistics of the keys of one Redis type.
+ */
+struct BigKeysTypeStats
+{
+    BigKeysTypeStats() : count(0), totalBytes(0), topKeys()
+    {
+        for (std::size_t i = 0; i < BIG_KEYS_HISTOGRAM_BUCKETS; ++i)
+            histogram[i] = 0;
+    }
+
+    /// Number of keys.
+    unsigned long long count;
+    /// Sum of the memory usage of the keys.
+    unsigned long long totalBytes;
+    /// Log2 scale memory usage histogram.
+    unsigned long long histogram[BIG_KEYS_HISTOGRAM_BUCKETS];
+    /// The biggest keys, a min-heap which holds at most top K keys.
+    std::vector<BigKey> topKeys;
+};
+
+/**
+ * @brief Aggregated statistics of the keys of one key prefix.
+ */
+struct BigKeysPrefixStats
+{
+    BigKeysPrefixStats() : count(0), totalBytes(0) {}
+
+    /// Number of keys.
+    unsigned long long count;
+    /// Sum of the memory usage of the keys.
+    unsigned long long totalBytes;
+};
+
+/**
+ * @brief Collects per type and per key prefix statistics of the keys
+ *        in a fixed amount of memory, no matter how many keys are added.
+ */
+class BigKeysStats
+{
+public:
+    /// The Redis key types.
+    enum KeyType
+    {
+        KEY_TYPE_STRING,
+        KEY_TYPE_LIST,
+        KEY_TYPE_SET,
+        KEY_TYPE_ZSET,
+        KEY_TYPE_HASH,
+        KEY_TYPE_STREAM,
+        KEY_TYPE_OTHER,
+        KEY_TYPE_COUNT
+    };
+
+public:
+    /**
+     * @param topK            How many of the biggest keys are kept per type.
+     * @param prefixDelimiter The key prefix is the part of the key before the first
+     *                        delimiter, empty string disables the prefix grouping.
+     * @param maxPrefixes     Maximum number of the prefix groups, the keys of the further
+     *                        prefixes are collected in the BIG_KEYS_OTHER_PREFIX group.
+     */
+    BigKeysStats(std::size_t topK, const std::string& prefixDelimiter, std::size_t maxPrefixes);
+
+    /**
+     * @brief Adds a key to the statistics.
+     *
+     * @param key      Name of the key.
+     * @param typeName Type of the key, as the TYPE command returns it.
+     * @param bytes    Memory usage of the key, as the MEMORY USAGE command returns it.
+     */
+    void Add(const std::string& key, const std::string& typeName, unsigned long long bytes);
+
+    /// Number of all the added keys.
+    unsigned long long GetKeyCount() const;
+    /// Sum of the memory usage of all the added keys.
+    unsigned long long GetTotalBytes() const;
+
+    const BigKeysTypeStats& GetTypeStats(KeyType type) const { return _types[type]; }
+    /**
+     * @brief Gets the biggest keys of a type.
+     *
+     * @param type The type.
+     * @return     At most top K keys ordered by memory usage, the biggest first.
+     */
+    std::vector<BigKey> GetTopKeys(KeyType type) const;
+
+    const std::map<std::string, BigKeysPrefixStats>& GetPrefixStats() const { return _prefixes; }
+
+    /**
+     * @brief Converts the name of a type, as the TYPE command returns it, to KeyType.
+     */
+    static KeyType GetKeyType(const std::string& typeName);
+    /**
+     * @brief Gets the name of a KeyType.
+     */
+    static const char* GetKeyTypeName(KeyType type);
+    /**
+     * @brief Gets the histogram bucket of a size: floor(log2(bytes)), 0 for 0 bytes.
+     */
+    static std::size_t GetHistogramBucket(unsigned long long bytes);
+
+private:
+    /**
+     * @brief Gets the prefix group of a key.
+     */
+    std::string GetPrefix(const std::string& key) const;
+
+    /// How many of the biggest keys are kept per type.
+    std::size_t _topK;
+    /// Delimiter of the key prefix, empty string if prefix grouping is disabled.
+    std::string _prefixDelimiter;
+    /// Maximum number of the prefix groups.
+    std::size_t _maxPrefixes;
+    /// Statistics per type.
+    BigKeysTypeStats _types[KEY_TYPE_COUNT];
+    /// Statistics per key prefix.
+    std::map<std::string, BigKeysPrefixStats> _prefixes;
+};
+
+}
@@ -25,13 +25,176 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <cerrno>
+#include <climits>
 #include <cstdlib>
 #include <cstring>
 
+#include "BigKeysAnalyzer.h"
+#include "MetricsSampler.h"
 #include "RedisConnectionStringParser.h"
 
 // The Redis CLI client program.
 #define REDIS_CLI "redis-cli"
+// The param which runs the native big keys analyzer instead of redis-cli.
+#define BIG_KEYS_PARAM "--bigkeys"
+// The param which runs the metrics sampler instead of redis-cli.
+#define METRICS_PARAM "--metrics"
+
+// Characters which never need quoting in a shell word.
+#define SHELL_SAFE_CHARACTERS "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_-.,:/@=+%"
+
+// Makes one shell word from a string: single-quotes it (a ' becomes '\'') unless it's safe as it is.
+static std::string ShellQuote(const std::string& word)
+{
+    if (!word.empty() && word.find_first_not_of(SHELL_SAFE_CHARACTERS) == std::string::npos)
+        return word;
+
+    std::string quoted = "'";
+    for (std::string::const_iterator itr = word.begin(); itr != word.end(); ++itr)
+    {
+        if (*itr == '\'')
+            quoted += "'\\''";
+        else
+            quoted += *itr;
+    }
+    return quoted + "'";
+}
+
+// Parses a positive integer param value which is at most max, returns false if it's invalid.
+static bool ParseCount(const char* value, std::size_t& count, std::size_t max = LONG_MAX)
+{
+    char* end = NULL;
+    errno = 0;
+    long parsed = std::strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || errno == ERANGE || parsed < 1 ||
+        static_cast<unsigned long>(parsed) > max)
+        return false;
+    count = parsed;
+    return true;
+}
+
+// Result of parsing one param of a mode (like --bigkeys).
+enum ParamResult
+{
+    PARAM_OK,
+    PARAM_INVALID,
+    PARAM_UNKNOWN
+};
+
+// Parses the "--param value" pairs after the connection string for a mode, skips the
+// mode's own param. parseParam handles one pair, it may throw std::runtime_error.
+// Returns false if any of the params is invalid.
+template <typename Options>
+static bool ParseModeParams(int argc, char* argv[], const char* modeParam, Options& options,
+                            ParamResult (*parseParam)(const std::string& param, const char* value, Options& options))
+{
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string param = argv[i];
+        if (param == modeParam)
+            continue;
+        // All the other params have a value.
+        if (i + 1 >= argc)
+        {
+            std::cout << "Error: Missing value of " << param << "." << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+
+        ParamResult result;
+        try
+        {
+            result = parseParam(param, value, options);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cout << "Error: " << e.what() << std::endl;
+            return false;
+        }
+
+        if (result == PARAM_UNKNOWN)
+        {
+            std::cout << "Error: Unknown " << modeParam << " param: " << param << "." << std::endl;
+            return false;
+        }
+        if (result == PARAM_INVALID)
+        {
+            std::cout << "Error: Invalid value of " << param << ": " << value << "." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Converts the validity of a param value to ParamResult.
+static ParamResult ToParamResult(bool valid)
+{
+    return valid ? PARAM_OK : PARAM_INVALID;
+}
+
+// Parses one param of the big keys analyzer.
+static ParamResult ParseBigKeysParam(const std::string& param, const char* value, redisCliCs::BigKeysOptions& options)
+{
+    if (param == "--connections")
+        return ToParamResult(ParseCount(value, options.connections, BIG_KEYS_MAX_CONNECTIONS));
+    if (param == "--top")
+        return ToParamResult(ParseCount(value, options.topK, BIG_KEYS_MAX_TOP_K));
+    if (param == "--scan-count")
+        return ToParamResult(ParseCount(value, options.scanCount, BIG_KEYS_MAX_SCAN_COUNT));
+    if (param == "--max-prefixes")
+        return ToParamResult(ParseCount(value, options.maxPrefixes, BIG_KEYS_MAX_PREFIXES));
+    if (param == "--prefix-delimiter")
+    {
+        options.prefixDelimiter = value;
+        return PARAM_OK;
+    }
+    if (param == "--sample")
+    {
+        char* end = NULL;
+        options.sampleRate = std::strtod(value, &end);
+        return ToParamResult(*value != '\0' && *end == '\0' && options.sampleRate > 0.0 && options.sampleRate <= 1.0);
+    }
+    return PARAM_UNKNOWN;
+}
+
+// The params of the metrics sampler.
+struct MetricsParams
+{
+    MetricsParams() : options(), endpoints() {}
+
+    redisCliCs::MetricsOptions options;
+    // The connection string's endpoint and the --endpoint ones.
+    std::vector<redisCliCs::RedisConnectionString> endpoints;
+};
+
+// Parses one param of the metrics sampler.
+static ParamResult ParseMetricsParam(const std::string& param, const char* value, MetricsParams& params)
+{
+    if (param == "--interval")
+        return ToParamResult(ParseCount(value, params.options.intervalMs, METRICS_MAX_INTERVAL_MS));
+    if (param == "--timeout")
+        return ToParamResult(ParseCount(value, params.options.timeoutMs, METRICS_MAX_TIMEOUT_MS));
+    if (param == "--count")
+        return ToParamResult(ParseCount(value, params.options.count));
+    if (param == "--format")
+    {
+        if (!strcmp(value, "table"))
+            params.options.format = redisCliCs::METRICS_FORMAT_TABLE;
+        else if (!strcmp(value, "ndjson"))
+            params.options.format = redisCliCs::METRICS_FORMAT_NDJSON;
+        else
+            return PARAM_INVALID;
+        return PARAM_OK;
+    }
+    if (param == "--endpoint")
+    {
+        params.endpoints.push_back(redisCliCs::RedisConnectionStringParser::Parse(value));
+        return PARAM_OK;
+    }
+    return PARAM_UNKNOWN;
+}
 
 int main(int argc, char* argv[])
 {
@@ -44,7 +207,31 @@ int main(int argc, char* argv[])
         std::cout << "Usage: redis-cli-cs redis_connection_string [custom params to redis-cli]" << std::endl;
         std::cout << "Examples:" << std::endl;
         std::cout << "  " << "redis-cli-cs redis://:foobar@example.com:37890/11" << std::endl;
-        std::cout << "  " << "redis-cli-cs redis://:foobar@example.com:37890/11 --bigkeys --latency-history" << std::endl;
+        std::cout << "  " << "redis-cli-cs redis://:foobar@example.com:37890/11 --latency-history" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Native big keys / memory usage analyzer (doesn't need redis-cli):" << std::endl;
+        std::cout << "  redis-cli-cs redis_connection_string " << BIG_KEYS_PARAM << " [options]" << std::endl;
+        std::cout << "  Analyzes the DB of the connection string's path, or all the DBs if it has no path." << std::endl;
+        std::cout << "    --connections N        Parallel TYPE / MEMORY USAGE connections (default 4, max "
+                  << BIG_KEYS_MAX_CONNECTIONS << ")." << std::endl;
+        std::cout << "    --top N                Biggest keys reported per type (default 10, max "
+                  << BIG_KEYS_MAX_TOP_K << ")." << std::endl;
+        std::cout << "    --scan-count N         COUNT hint of SCAN (default 1000, max "
+                  << BIG_KEYS_MAX_SCAN_COUNT << ")." << std::endl;
+        std::cout << "    --sample RATE          Analyzes only this ratio of the keys, in (0, 1]." << std::endl;
+        std::cout << "    --prefix-delimiter S   Groups the keys by their prefix before S." << std::endl;
+        std::cout << "    --max-prefixes N       Maximum number of prefix groups (default 1024, max "
+                  << BIG_KEYS_MAX_PREFIXES << ")." << std::endl;
+        std::cout << "  " << "redis-cli-cs redis://:foobar@example.com:37890 --bigkeys --sample 0.1 --prefix-delimiter :" << std::endl;
+        std::cout << std::endl;
+        std::cout << "Metrics sampler, polls INFO and LATENCY LATEST on one open connection per endpoint:" << std::endl;
+        std::cout << "  redis-cli-cs redis_connection_string " << METRICS_PARAM << " [options]" << std::endl;
+        std::cout << "    --interval MS          Time between two samples (default 1000)." << std::endl;
+        std::cout << "    --timeout MS           An endpoint which doesn't reply in time (at most the interval) is shown as missing (default 1000)." << std::endl;
+        std::cout << "    --count N              Stops after N samples (default: never)." << std::endl;
+        std::cout << "    --format table|ndjson  Live table or one JSON object per line (default table)." << std::endl;
+        std::cout << "    --endpoint URI         Samples another Redis server too, may be repeated." << std::endl;
+        std::cout << "  " << "redis-cli-cs redis://:foobar@example.com:37890 --metrics --interval 250 --format ndjson" << std::endl;
         return 0;
     }
 
@@ -61,37 +248,70 @@ int main(int argc, char* argv[])
         return 1;
     }
 
+    // Runs the native big keys analyzer.
+    for (int i = 2; i < argc; ++i)
+    {
+        if (strcmp(argv[i], BIG_KEYS_PARAM))
+            continue;
+
+        redisCliCs::BigKeysOptions options;
+        if (!ParseModeParams(argc, argv, BIG_KEYS_PARAM, options, ParseBigKeysParam))
+            return 1;
+        try
+        {
+            redisCliCs::BigKeysAnalyzer analyzer(cs, options);
+            analyzer.Run(std::cout);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cout << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // Runs the metrics sampler.
+    for (int i = 2; i < argc; ++i)
+    {
+        if (strcmp(argv[i], METRICS_PARAM))
+            continue;
+
+        MetricsParams params;
+        params.endpoints.push_back(cs);
+        if (!ParseModeParams(argc, argv, METRICS_PARAM, params, ParseMetricsParam))
+            return 1;
+        try
+        {
+            redisCliCs::MetricsSampler sampler(params.endpoints, params.options);
+            sampler.Run(std::cout);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cout << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     // Extracts the data from the connection string (URI).
     std::string password = cs.GetPassword();
     std::string hostname = cs.GetHostname();
-    std::string port = cs.GetPort();
-    std::string db = cs.GetPath();
 
     std::stringstream redisCommand;
     redisCommand << REDIS_CLI;
 
     if (!password.empty())
-        redisCommand << " -a " << "\"" << password << "\"";
+        redisCommand << " -a " << ShellQuote(password);
     if (!hostname.empty())
-        redisCommand << " -h " << "\"" << hostname << "\"" ;
-    if (!port.empty())
-        redisCommand << " -p " << "\"" << port << "\"" ;
-    if (!db.empty())
-        redisCommand << " -n " << "\"" << db << "\"" ;
+        redisCommand << " -h " << ShellQuote(hostname);
+    if (cs.HasPort())
+        redisCommand << " -p " << cs.GetPort();
+    if (cs.HasDb())
+        redisCommand << " -n " << cs.GetDb();
 
-    // If any custom params given appends to the command.
+    // If any custom params given appends to the command, quoted so the shell passes them as they are.
     for (int i = 2; i < argc; ++i)
-    {
-        // Gets the custom param.
-        std::string param = argv[i];
-        redisCommand << " ";
-        // If the param contains space.
-        if (param.find_first_of(" ") != std::string::npos)
-            redisCommand << "\"";
-        redisCommand << param;
-        if (param.find_first_of(" ") != std::string::npos)
-            redisCommand << "\"";
-    }
+        redisCommand << " " << ShellQuote(argv[i]);
 
     std::cout << "Executing... " << redisCommand.str() << std::endl;
     std::system(redisCommand.str().c_str());
@@ -0,0 +1,152 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "MetricsParser.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace redisCliCs
+{
+
+/// Prefix of the INFO commandstats fields.
+#define INFO_COMMANDSTATS_PREFIX "cmdstat_"
+/// Prefix of the INFO keyspace fields.
+#define INFO_KEYSPACE_PREFIX "db"
+/// Header of the INFO keyspace section.
+#define INFO_KEYSPACE_HEADER "# Keyspace"
+
+void MetricsParser::ParseInfo(const std::string& info, MetricsSample& sample)
+{
+    // Works on positions instead of substrings, so a sample doesn't allocate per line.
+    std::size_t lineEnd = 0;
+    for (std::size_t pos = 0; pos < info.length(); pos = lineEnd + 1)
+    {
+        lineEnd = info.find('\n', pos);
+        if (lineEnd == std::string::npos)
+            lineEnd = info.length();
+        std::size_t end = lineEnd;
+        if (end > pos && info[end - 1] == '\r')
+            --end;
+
+        // The keyspace section has no lines when there are no keys.
+        if (end - pos == std::strlen(INFO_KEYSPACE_HEADER) && !info.compare(pos, end - pos, INFO_KEYSPACE_HEADER))
+        {
+            Accumulate(sample, METRIC_KEYS, 0);
+            continue;
+        }
+        // Empty line or section header.
+        if (end == pos || info[pos] == '#')
+            continue;
+        std::size_t colonPos = info.find(':', pos);
+        if (colonPos == std::string::npos || colonPos >= end)
+            continue;
+        std::size_t nameLength = colonPos - pos;
+        std::size_t valuePos = colonPos + 1;
+
+        double value = 0;
+        if (!info.compare(pos, std::strlen(INFO_COMMANDSTATS_PREFIX), INFO_COMMANDSTATS_PREFIX))
+        {
+            // cmdstat_get:calls=10,usec=20,usec_per_call=2.00
+            if (ParseField(info, valuePos, end, "calls", value))
+                Accumulate(sample, METRIC_COMMAND_CALLS, value);
+            if (ParseField(info, valuePos, end, "usec", value))
+                Accumulate(sample, METRIC_COMMAND_USEC, value);
+            continue;
+        }
+
+        if (!info.compare(pos, std::strlen(INFO_KEYSPACE_PREFIX), INFO_KEYSPACE_PREFIX) &&
+            nameLength > std::strlen(INFO_KEYSPACE_PREFIX) &&
+            std::isdigit(static_cast<unsigned char>(info[pos + std::strlen(INFO_KEYSPACE_PREFIX)])))
+        {
+            // db0:keys=1,expires=0,avg_ttl=0
+            if (ParseField(info, valuePos, end, "keys", value))
+                Accumulate(sample, METRIC_KEYS, value);
+            continue;
+        }
+
+        // The plain INFO fields are the metrics before METRIC_KEYS.
+        for (int metric = 0; metric < METRIC_KEYS; ++metric)
+        {
+            const char* name = GetMetricName(static_cast<Metric>(metric));
+            if (nameLength != std::strlen(name) || info.compare(pos, nameLength, name))
+                continue;
+            const char* valueStr = info.c_str() + valuePos;
+            char* valueEnd = NULL;
+            value = std::strtod(valueStr, &valueEnd);
+            if (valueEnd != valueStr)
+                sample.values[metric] = value;
+            break;
+        }
+    }
+}
+
+void MetricsParser::ParseLatencyLatest(const RedisReply& reply, MetricsSample& sample)
+{
+    if (reply.GetType() != RedisReply::REPLY_ARRAY)
+        return;
+
+    // No events means no latency spike above the threshold.
+    double latest = 0;
+    const std::vector<RedisReply>& events = reply.GetElements();
+    for (std::vector<RedisReply>::const_iterator itr = events.begin(); itr != events.end(); ++itr)
+    {
+        if (itr->GetType() != RedisReply::REPLY_ARRAY || itr->GetElements().size() < 3)
+            continue;
+        double eventLatest = static_cast<double>(itr->GetElements()[2].GetInteger());
+        if (eventLatest > latest)
+            latest = eventLatest;
+    }
+    sample.values[METRIC_LATENCY_LATEST_MS] = latest;
+}
+
+bool MetricsParser::ParseField(const std::string& info, std::size_t begin, std::size_t end,
+                               const char* field, double& value)
+{
+    std::size_t fieldLength = std::strlen(field);
+    std::size_t itemEnd = begin;
+    for (std::size_t pos = begin; pos < end; pos = itemEnd + 1)
+    {
+        itemEnd = info.find(',', pos);
+        if (itemEnd == std::string::npos || itemEnd > end)
+            itemEnd = end;
+        if (pos + fieldLength < itemEnd && !info.compare(pos, fieldLength, field) && info[pos + fieldLength] == '=')
+        {
+            value = std::strtod(info.c_str() + pos + fieldLength + 1, NULL);
+            return true;
+        }
+    }
+    return false;
+}
+
+void MetricsParser::Accumulate(MetricsSample& sample, Metric metric, double value)
+{
+    // NaN != NaN, so the first value replaces the missing one.
+    if (sample.values[metric] != sample.values[metric])
+        sample.values[metric] = 0;
+    sample.values[metric] += value;
+}
+
+}
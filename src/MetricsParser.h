@@ -0,0 +1,82 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "MetricsSample.h"
+#include "RedisReply.h"
+
+namespace redisCliCs
+{
+
+/**
+ * @brief Parses the replies of the Redis monitoring commands to metrics.
+ */
+class MetricsParser
+{
+public:
+    /**
+     * @brief Parses the reply of INFO (all sections) to the metrics.
+     *
+     * The known fields are parsed from the lines, the commandstats and
+     * keyspace sections are summed, an empty keyspace section gives 0 keys.
+     * The unknown fields are skipped.
+     *
+     * @param info   The INFO reply.
+     * @param sample Receives the metrics, the ones not in the reply are left untouched.
+     *               The sums are added to the current values, so it should be Reset() first.
+     */
+    static void ParseInfo(const std::string& info, MetricsSample& sample);
+
+    /**
+     * @brief Parses the reply of LATENCY LATEST to METRIC_LATENCY_LATEST_MS.
+     *
+     * @param reply  The LATENCY LATEST reply, an array of [event, timestamp, latest, max].
+     * @param sample Receives the metric, left untouched if the reply is an error.
+     */
+    static void ParseLatencyLatest(const RedisReply& reply, MetricsSample& sample);
+
+private:
+    /**
+     * @brief Parses a "name=value" field of a comma separated INFO value,
+     *        like the ones of the commandstats and keyspace sections.
+     *
+     * @param info     The INFO reply.
+     * @param begin    Position of the first byte of the value.
+     * @param end      Position after the last byte of the value.
+     * @param field    Name of the field.
+     * @param value    Receives the value of the field.
+     * @return         True if the field was found.
+     */
+    static bool ParseField(const std::string& info, std::size_t begin, std::size_t end,
+                           const char* field, double& value);
+    /**
+     * @brief Adds a value to a metric, treats NaN as 0.
+     */
+    static void Accumulate(MetricsSample& sample, Metric metric, double value);
+};
+
+}
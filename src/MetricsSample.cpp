@@ -0,0 +1,137 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "MetricsSample.h"
+
+#include <limits>
+
+namespace redisCliCs
+{
+
+namespace
+{
+
+/// Names of the metrics, indexed by Metric.
+const char* const METRIC_NAMES[METRIC_COUNT] =
+{
+    "connected_clients",
+    "blocked_clients",
+    "used_memory",
+    "used_memory_rss",
+    "mem_fragmentation_ratio",
+    "total_connections_received",
+    "rejected_connections",
+    "total_commands_processed",
+    "instantaneous_ops_per_sec",
+    "total_net_input_bytes",
+    "total_net_output_bytes",
+    "keyspace_hits",
+    "keyspace_misses",
+    "expired_keys",
+    "evicted_keys",
+    "keys",
+    "command_calls",
+    "command_usec",
+    "latency_latest_ms"
+};
+
+double NotANumber()
+{
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+/// Gets the per second rate of a counter, NaN if it's missing or was reset.
+double CounterRate(const MetricsSample& previous, const MetricsSample& current, Metric metric, double seconds)
+{
+    double delta = current.values[metric] - previous.values[metric];
+    // NaN compares false, so this catches the missing values too.
+    if (!(delta >= 0) || !(seconds > 0))
+        return NotANumber();
+    return delta / seconds;
+}
+
+}
+
+MetricsSample::MetricsSample() : timestamp(0),
+                                 missing(false),
+                                 selfCommands(0)
+{
+    Reset();
+}
+
+void MetricsSample::Reset()
+{
+    for (int i = 0; i < METRIC_COUNT; ++i)
+        values[i] = NotANumber();
+}
+
+MetricsRates::MetricsRates() : opsPerSec(NotANumber()),
+                               hitRatio(NotANumber()),
+                               evictionsPerSec(NotANumber()),
+                               expirationsPerSec(NotANumber()),
+                               netInputPerSec(NotANumber()),
+                               netOutputPerSec(NotANumber()),
+                               usecPerCall(NotANumber())
+{
+}
+
+MetricsRates MetricsRates::Compute(const MetricsSample& previous, const MetricsSample& current)
+{
+    MetricsRates rates;
+    double seconds = current.timestamp - previous.timestamp;
+
+    // The sampler's own INFO and LATENCY would add a constant noise, mostly at short intervals.
+    rates.opsPerSec = CounterRate(previous, current, METRIC_TOTAL_COMMANDS_PROCESSED, seconds);
+    double selfCommands = current.selfCommands - previous.selfCommands;
+    if (rates.opsPerSec == rates.opsPerSec && selfCommands > 0)
+    {
+        rates.opsPerSec -= selfCommands / seconds;
+        if (rates.opsPerSec < 0)
+            rates.opsPerSec = 0;
+    }
+    rates.evictionsPerSec = CounterRate(previous, current, METRIC_EVICTED_KEYS, seconds);
+    rates.expirationsPerSec = CounterRate(previous, current, METRIC_EXPIRED_KEYS, seconds);
+    rates.netInputPerSec = CounterRate(previous, current, METRIC_TOTAL_NET_INPUT_BYTES, seconds);
+    rates.netOutputPerSec = CounterRate(previous, current, METRIC_TOTAL_NET_OUTPUT_BYTES, seconds);
+
+    // The ratios are computed from the deltas, so they describe only this interval.
+    double hits = CounterRate(previous, current, METRIC_KEYSPACE_HITS, seconds);
+    double misses = CounterRate(previous, current, METRIC_KEYSPACE_MISSES, seconds);
+    if (hits + misses > 0)
+        rates.hitRatio = hits / (hits + misses);
+
+    double calls = CounterRate(previous, current, METRIC_COMMAND_CALLS, seconds);
+    double usec = CounterRate(previous, current, METRIC_COMMAND_USEC, seconds);
+    if (calls > 0 && usec >= 0)
+        rates.usecPerCall = usec / calls;
+
+    return rates;
+}
+
+const char* GetMetricName(Metric metric)
+{
+    return METRIC_NAMES[metric];
+}
+
+}
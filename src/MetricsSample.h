@@ -0,0 +1,130 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include "RingBuffer.h"
+
+namespace redisCliCs
+{
+
+/// Number of the samples kept per endpoint, the window rates cover this many samples.
+#define METRICS_HISTORY_SIZE 60
+
+/// The numeric series which are sampled from a Redis server.
+enum Metric
+{
+    // INFO fields.
+    METRIC_CONNECTED_CLIENTS,
+    METRIC_BLOCKED_CLIENTS,
+    METRIC_USED_MEMORY,
+    METRIC_USED_MEMORY_RSS,
+    METRIC_MEM_FRAGMENTATION_RATIO,
+    METRIC_TOTAL_CONNECTIONS_RECEIVED,
+    METRIC_REJECTED_CONNECTIONS,
+    METRIC_TOTAL_COMMANDS_PROCESSED,
+    METRIC_INSTANTANEOUS_OPS_PER_SEC,
+    METRIC_TOTAL_NET_INPUT_BYTES,
+    METRIC_TOTAL_NET_OUTPUT_BYTES,
+    METRIC_KEYSPACE_HITS,
+    METRIC_KEYSPACE_MISSES,
+    METRIC_EXPIRED_KEYS,
+    METRIC_EVICTED_KEYS,
+    // Sum of the keys of all the DBs from INFO keyspace.
+    METRIC_KEYS,
+    // Sum of the calls and usec of all the commands from INFO commandstats.
+    METRIC_COMMAND_CALLS,
+    METRIC_COMMAND_USEC,
+    // The highest latest latency of the LATENCY LATEST events.
+    METRIC_LATENCY_LATEST_MS,
+    METRIC_COUNT
+};
+
+/**
+ * @brief One sample of all the metrics of a Redis server.
+ *
+ * The metrics which weren't reported by the server are NaN. When the server
+ * couldn't be polled the sample is missing and all its metrics are NaN.
+ */
+struct MetricsSample
+{
+    MetricsSample();
+
+    /// Sets all the metrics to NaN.
+    void Reset();
+
+    /// Unix time of the sample in seconds.
+    double timestamp;
+    /// True if the server couldn't be polled.
+    bool missing;
+    /// Number of the commands the sampler itself sent on the connection before
+    /// this sample's INFO, they are subtracted from the processed commands.
+    double selfCommands;
+    /// Values of the metrics, indexed by Metric.
+    double values[METRIC_COUNT];
+};
+
+/**
+ * @brief Rates and ratios between two samples of a Redis server.
+ *
+ * The ones which can't be computed (missing metric, counter reset, no requests) are NaN.
+ */
+struct MetricsRates
+{
+    MetricsRates();
+
+    /**
+     * @brief Computes the rates between two samples.
+     *
+     * @param previous The earlier sample.
+     * @param current  The later sample.
+     */
+    static MetricsRates Compute(const MetricsSample& previous, const MetricsSample& current);
+
+    /// Processed commands per second, without the sampler's own commands.
+    double opsPerSec;
+    /// Keyspace hits / (hits + misses).
+    double hitRatio;
+    /// Evicted keys per second.
+    double evictionsPerSec;
+    /// Expired keys per second.
+    double expirationsPerSec;
+    /// Network input in bytes per second.
+    double netInputPerSec;
+    /// Network output in bytes per second.
+    double netOutputPerSec;
+    /// Average command execution time in microseconds, from INFO commandstats,
+    /// which counts the sampler's own INFO and LATENCY calls too.
+    double usecPerCall;
+};
+
+/// The last samples of an endpoint.
+typedef RingBuffer<MetricsSample, METRICS_HISTORY_SIZE> MetricsHistory;
+
+/**
+ * @brief Gets the name of a metric, which is the INFO field name where there is one.
+ */
+const char* GetMetricName(Metric metric);
+
+}
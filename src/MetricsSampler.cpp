@@ -0,0 +1,282 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "MetricsSampler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <set>
+
+#include <poll.h>
+#include <sys/time.h>
+
+#include "MetricsParser.h"
+#include "MetricsWriter.h"
+
+namespace redisCliCs
+{
+
+/// Number of the commands sent per sample: INFO and LATENCY LATEST.
+#define METRICS_COMMANDS_PER_SAMPLE 2
+
+MetricsSampler::MetricsSampler(const std::vector<RedisConnectionString>& endpoints, const MetricsOptions& options) :
+    _options(options),
+    _endpoints(),
+    _tableRows(0)
+{
+    // INFO and LATENCY describe the whole server, so the connection strings which differ
+    // only in the DB or the credentials would give the same, indistinguishable stream.
+    std::set<uint64_t> serverHashes;
+    for (std::vector<RedisConnectionString>::const_iterator itr = endpoints.begin(); itr != endpoints.end(); ++itr)
+        if (serverHashes.insert(itr->GetServerHash()).second)
+            _endpoints.push_back(new Endpoint(*itr, itr->GetEndpointName()));
+
+    for (std::vector<Endpoint*>::iterator itr = _endpoints.begin(); itr != _endpoints.end(); ++itr)
+        (*itr)->connection.SetTimeout(_options.timeoutMs);
+}
+
+MetricsSampler::~MetricsSampler()
+{
+    for (std::vector<Endpoint*>::iterator itr = _endpoints.begin(); itr != _endpoints.end(); ++itr)
+        delete *itr;
+}
+
+void MetricsSampler::Run(std::ostream& out)
+{
+    bool multipleEndpoints = _endpoints.size() > 1;
+
+    // The samples are scheduled from the start, so slow replies don't make the interval drift.
+    double start = Now();
+    double interval = _options.intervalMs / 1000.0;
+    std::size_t tick = 0;
+    for (std::size_t n = 0; !_options.count || n < _options.count; ++n)
+    {
+        if (n)
+        {
+            tick = GetNextTick(start, interval, tick, Now());
+            SleepUntil(start + tick * interval);
+        }
+
+        // A reply which arrives after the next tick would be late anyway.
+        Poll(start + (tick + 1) * interval);
+        for (std::vector<Endpoint*>::const_iterator itr = _endpoints.begin(); itr != _endpoints.end(); ++itr)
+        {
+            if (_options.format == METRICS_FORMAT_NDJSON)
+            {
+                MetricsWriter::WriteNdjson(out, (*itr)->name, (*itr)->history);
+                continue;
+            }
+            if (!(_tableRows % METRICS_TABLE_HEADER_INTERVAL))
+                MetricsWriter::WriteTableHeader(out, multipleEndpoints);
+            MetricsWriter::WriteTableRow(out, multipleEndpoints ? (*itr)->name : "", (*itr)->history);
+            ++_tableRows;
+        }
+        out.flush();
+    }
+}
+
+std::size_t MetricsSampler::GetNextTick(double start, double interval, std::size_t tick, double now)
+{
+    // The first tick which is less than half an interval in the past, so a tick
+    // which is only just passed (like the one Poll() waited for) is still taken.
+    double first = std::ceil((now - start) / interval - 0.5);
+    if (first > tick + 1)
+        return static_cast<std::size_t>(first);
+    return tick + 1;
+}
+
+void MetricsSampler::Poll(double nextTick)
+{
+    // Sends the commands to all the endpoints first, so they are polled in parallel.
+    // The failed endpoints already got their missing sample.
+    std::vector<std::size_t> waiting;
+    for (std::size_t i = 0; i < _endpoints.size(); ++i)
+        if (Send(*_endpoints[i]))
+            waiting.push_back(i);
+
+    // The replies of all the endpoints are awaited together, until one deadline,
+    // so a stalled endpoint doesn't delay the others.
+    double timestamp = Now();
+    double deadline = std::min(timestamp + _options.timeoutMs / 1000.0, nextTick);
+    std::vector<std::vector<RedisReply> > replies(_endpoints.size());
+    while (!waiting.empty())
+    {
+        std::vector<std::size_t> receiving;
+        std::vector<struct pollfd> sockets;
+        for (std::vector<std::size_t>::const_iterator itr = waiting.begin(); itr != waiting.end(); ++itr)
+        {
+            if (Receive(*_endpoints[*itr], replies[*itr], timestamp))
+                continue;
+            struct pollfd pfd;
+            pfd.fd = _endpoints[*itr]->connection.GetSocket();
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            sockets.push_back(pfd);
+            receiving.push_back(*itr);
+        }
+        if (receiving.empty())
+            break;
+
+        double remaining = deadline - Now();
+        int ready = remaining > 0 ? poll(&sockets[0], sockets.size(), static_cast<int>(remaining * 1000) + 1) : 0;
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready <= 0)
+        {
+            std::string error = ready ? std::string("Poll error: ") + std::strerror(errno) : "Read timed out.";
+            for (std::vector<std::size_t>::const_iterator itr = receiving.begin(); itr != receiving.end(); ++itr)
+                Fail(*_endpoints[*itr], timestamp, error);
+            break;
+        }
+
+        waiting.clear();
+        for (std::size_t i = 0; i < receiving.size(); ++i)
+        {
+            Endpoint& endpoint = *_endpoints[receiving[i]];
+            if (sockets[i].revents)
+            {
+                try
+                {
+                    endpoint.connection.ReadAvailable();
+                }
+                catch (const std::runtime_error& e)
+                {
+                    Fail(endpoint, timestamp, e.what());
+                    continue;
+                }
+            }
+            waiting.push_back(receiving[i]);
+        }
+    }
+}
+
+bool MetricsSampler::Send(Endpoint& endpoint)
+{
+    try
+    {
+        if (!endpoint.connection.IsConnected())
+        {
+            endpoint.connection.Connect(endpoint.cs);
+            endpoint.selfCommands = 0;
+        }
+        endpoint.connection.AppendCommand(RedisCommand("INFO") << "all");
+        endpoint.connection.AppendCommand(RedisCommand("LATENCY") << "LATEST");
+        endpoint.connection.Flush();
+        return true;
+    }
+    catch (const std::runtime_error& e)
+    {
+        Fail(endpoint, Now(), e.what());
+        return false;
+    }
+}
+
+bool MetricsSampler::Receive(Endpoint& endpoint, std::vector<RedisReply>& replies, double timestamp)
+{
+    try
+    {
+        // Takes only the replies which have arrived, ReadReply() doesn't block for them.
+        while (replies.size() < METRICS_COMMANDS_PER_SAMPLE && endpoint.connection.HasReply())
+            replies.push_back(endpoint.connection.ReadReply());
+        if (replies.size() < METRICS_COMMANDS_PER_SAMPLE)
+            return false;
+
+        const RedisReply& info = replies[0];
+        const RedisReply& latency = replies[1];
+        if (info.IsError())
+            throw RedisConnection::ReplyErrorException(info.GetString());
+
+        MetricsSample sample;
+        sample.timestamp = timestamp;
+        sample.selfCommands = endpoint.selfCommands;
+        endpoint.selfCommands += METRICS_COMMANDS_PER_SAMPLE;
+        MetricsParser::ParseInfo(info.GetString(), sample);
+        // Older servers don't have LATENCY, then it stays NaN.
+        MetricsParser::ParseLatencyLatest(latency, sample);
+        AddSample(endpoint.history, sample);
+
+        if (endpoint.failed)
+            std::cerr << endpoint.name << ": recovered." << std::endl;
+        endpoint.failed = false;
+        return true;
+    }
+    catch (const std::runtime_error& e)
+    {
+        Fail(endpoint, timestamp, e.what());
+        return true;
+    }
+}
+
+void MetricsSampler::Fail(Endpoint& endpoint, double timestamp, const std::string& error)
+{
+    // The unread replies would be taken as the replies of the next sample, so it has to reconnect.
+    endpoint.connection.Close();
+    // Reported only once, and not in the output, so NDJSON stays valid.
+    if (!endpoint.failed)
+        std::cerr << endpoint.name << ": " << error << std::endl;
+    endpoint.failed = true;
+
+    MetricsSample sample;
+    sample.timestamp = timestamp;
+    sample.missing = true;
+    AddSample(endpoint.history, sample);
+}
+
+void MetricsSampler::AddSample(MetricsHistory& history, const MetricsSample& sample)
+{
+    // The window rates would stay NaN until the sample before the gap or the reset
+    // left the history. The counters may have been reset while the endpoint was missing.
+    if (!history.Empty() &&
+        (sample.missing || history.Newest().missing ||
+         sample.values[METRIC_TOTAL_COMMANDS_PROCESSED] < history.Newest().values[METRIC_TOTAL_COMMANDS_PROCESSED]))
+        history.Clear();
+    history.Push(sample);
+}
+
+double MetricsSampler::Now()
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+void MetricsSampler::SleepUntil(double time)
+{
+    double remaining = time - Now();
+    if (remaining <= 0)
+        return;
+
+    struct timespec request;
+    request.tv_sec = static_cast<time_t>(remaining);
+    request.tv_nsec = static_cast<long>((remaining - request.tv_sec) * 1000000000);
+    // Continues with the remaining time when a signal interrupts the sleep.
+    while (nanosleep(&request, &request) < 0 && errno == EINTR)
+        ;
+}
+
+}
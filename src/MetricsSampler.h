@@ -0,0 +1,202 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "MetricsSample.h"
+#include "RedisConnection.h"
+#include "RedisConnectionString.h"
+
+namespace redisCliCs
+{
+
+/// The table header is repeated after this many rows.
+#define METRICS_TABLE_HEADER_INTERVAL 20
+/// Upper limit of MetricsOptions::intervalMs, one day.
+#define METRICS_MAX_INTERVAL_MS 86400000
+/// Upper limit of MetricsOptions::timeoutMs.
+#define METRICS_MAX_TIMEOUT_MS 60000
+
+/// Output formats of the metrics sampler.
+enum MetricsFormat
+{
+    /// A compact table, one row per sample per endpoint.
+    METRICS_FORMAT_TABLE,
+    /// One JSON object per line per sample per endpoint.
+    METRICS_FORMAT_NDJSON
+};
+
+/**
+ * @brief Options of the metrics sampler.
+ */
+struct MetricsOptions
+{
+    MetricsOptions() : intervalMs(1000),
+                       timeoutMs(1000),
+                       count(0),
+                       format(METRICS_FORMAT_TABLE) {}
+
+    /// Time between two samples in milliseconds.
+    std::size_t intervalMs;
+    /// Timeout of connecting to an endpoint and of the replies of a sample (at most the interval) in milliseconds.
+    std::size_t timeoutMs;
+    /// Number of the samples, 0 means no limit.
+    std::size_t count;
+    /// Output format.
+    MetricsFormat format;
+};
+
+/**
+ * @brief Polls INFO and LATENCY LATEST of Redis servers at a fixed interval
+ *        and writes the metrics and the rates computed from them.
+ *
+ * Every endpoint has one connection which is kept open, and a fixed size
+ * history of the samples. The rates are computed from the last two samples
+ * and from the whole history (the window rates).
+ *
+ * An endpoint which fails or doesn't reply within the timeout (or until the next
+ * tick) gets a missing sample, the others are still written. It's reconnected at the next tick.
+ */
+class MetricsSampler
+{
+public:
+    /**
+     * @param endpoints Connection strings of the Redis servers, the ones which point to
+     *                  the same server (hostname and port) are sampled only once.
+     * @param options   Options.
+     */
+    MetricsSampler(const std::vector<RedisConnectionString>& endpoints, const MetricsOptions& options);
+    ~MetricsSampler();
+
+    /**
+     * @brief Samples the endpoints until the sample count is reached.
+     *
+     * @param out Output of the samples.
+     */
+    void Run(std::ostream& out);
+
+    /**
+     * @brief Gets the number of the sampled endpoints.
+     */
+    std::size_t GetEndpointCount() const { return _endpoints.size(); }
+
+    /**
+     * @brief Gets the tick of the next sample. The ticks which passed more than
+     *        half an interval ago are skipped, a burst of samples right after each
+     *        other (after a stall) would give meaningless rates.
+     *
+     * @param start    Unix time of tick 0 in seconds.
+     * @param interval Time between two ticks in seconds.
+     * @param tick     The current tick.
+     * @param now      The current Unix time in seconds.
+     * @return         The first tick after the current one which isn't more than
+     *                 half an interval in the past.
+     */
+    static std::size_t GetNextTick(double start, double interval, std::size_t tick, double now);
+    /**
+     * @brief Adds a sample to the history of an endpoint. The history is cleared first when
+     *        the window rates couldn't be computed across the new sample: when it or the
+     *        newest one is missing, or the counters were reset (CONFIG RESETSTAT, restart).
+     *
+     * @param history The history of the endpoint.
+     * @param sample  The new sample.
+     */
+    static void AddSample(MetricsHistory& history, const MetricsSample& sample);
+
+private:
+    /**
+     * @brief A sampled Redis server.
+     */
+    struct Endpoint
+    {
+        Endpoint(const RedisConnectionString& endpointCs, const std::string& endpointName) :
+            cs(endpointCs), name(endpointName), connection(), history(), selfCommands(0), failed(false) {}
+
+        /// Connection string.
+        RedisConnectionString cs;
+        /// Name in the output, see RedisConnectionString::GetEndpointName().
+        std::string name;
+        /// The connection which is kept open.
+        RedisConnection connection;
+        /// The last samples.
+        MetricsHistory history;
+        /// Number of the commands sent on the connection, see MetricsSample::selfCommands.
+        double selfCommands;
+        /// True if the last poll failed, so the error is reported only once.
+        bool failed;
+    };
+
+    MetricsSampler(const MetricsSampler&);
+    MetricsSampler& operator=(const MetricsSampler&);
+
+    /**
+     * @brief Takes one sample of every endpoint. The replies of all the endpoints
+     *        are awaited together, until the timeout or the next tick.
+     *
+     * @param nextTick Unix time of the next tick in seconds.
+     */
+    void Poll(double nextTick);
+    /**
+     * @brief Sends the commands of a sample to an endpoint, connects first if needed.
+     *
+     * @return False if the endpoint failed.
+     */
+    bool Send(Endpoint& endpoint);
+    /**
+     * @brief Takes the replies of a sample which have arrived from an endpoint,
+     *        adds the sample when both are there.
+     *
+     * @param endpoint  The endpoint.
+     * @param replies   The replies taken so far.
+     * @param timestamp Unix time of the sample in seconds.
+     * @return          True if the endpoint is done: its sample is added or it failed.
+     */
+    bool Receive(Endpoint& endpoint, std::vector<RedisReply>& replies, double timestamp);
+    /**
+     * @brief Closes the connection of a failed endpoint and adds a missing sample.
+     */
+    void Fail(Endpoint& endpoint, double timestamp, const std::string& error);
+
+    /**
+     * @brief Gets the current Unix time in seconds.
+     */
+    static double Now();
+    /**
+     * @brief Sleeps until the given Unix time, returns at once if it has passed.
+     */
+    static void SleepUntil(double time);
+
+    /// Options.
+    MetricsOptions _options;
+    /// The sampled Redis servers.
+    std::vector<Endpoint*> _endpoints;
+    /// Number of the table rows written since the last header.
+    std::size_t _tableRows;
+};
+
+}
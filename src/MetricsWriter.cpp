@@ -0,0 +1,186 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "MetricsWriter.h"
+
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+namespace redisCliCs
+{
+
+void MetricsWriter::WriteTableHeader(std::ostream& out, bool withEndpoint)
+{
+    out << std::left << std::setw(13) << "time" << std::right
+        << std::setw(10) << "ops/s"
+        << std::setw(7) << "hit%"
+        << std::setw(9) << "evict/s"
+        << std::setw(9) << "expire/s"
+        << std::setw(8) << "clients"
+        << std::setw(10) << "mem MB"
+        << std::setw(6) << "frag"
+        << std::setw(10) << "in KB/s"
+        << std::setw(10) << "out KB/s"
+        << std::setw(9) << "us/call"
+        << std::setw(8) << "lat ms"
+        << std::setw(12) << "keys";
+    if (withEndpoint)
+        out << "  endpoint";
+    out << std::endl;
+}
+
+void MetricsWriter::WriteTableRow(std::ostream& out, const std::string& endpoint, const MetricsHistory& history)
+{
+    const MetricsSample& sample = history.Newest();
+    MetricsRates rates;
+    if (history.Size() > 1)
+        rates = MetricsRates::Compute(history.Newest(1), sample);
+
+    // Local time with milliseconds, the date isn't interesting in a live view.
+    time_t seconds = static_cast<time_t>(sample.timestamp);
+    struct tm localTime;
+    localtime_r(&seconds, &localTime);
+    char timeStr[16];
+    strftime(timeStr, sizeof(timeStr), "%H:%M:%S", &localTime);
+    int millis = static_cast<int>((sample.timestamp - seconds) * 1000);
+
+    std::ostringstream time;
+    time << timeStr << "." << std::setw(3) << std::setfill('0') << millis;
+
+    out << std::left << std::setw(13) << time.str() << std::right
+        << std::setw(10) << Cell(rates.opsPerSec, 0)
+        << std::setw(7) << Cell(rates.hitRatio * 100, 1)
+        << std::setw(9) << Cell(rates.evictionsPerSec, 0)
+        << std::setw(9) << Cell(rates.expirationsPerSec, 0)
+        << std::setw(8) << Cell(sample.values[METRIC_CONNECTED_CLIENTS], 0)
+        << std::setw(10) << Cell(sample.values[METRIC_USED_MEMORY], 1, 1024 * 1024)
+        << std::setw(6) << Cell(sample.values[METRIC_MEM_FRAGMENTATION_RATIO], 2)
+        << std::setw(10) << Cell(rates.netInputPerSec, 1, 1024)
+        << std::setw(10) << Cell(rates.netOutputPerSec, 1, 1024)
+        << std::setw(9) << Cell(rates.usecPerCall, 2)
+        << std::setw(8) << Cell(sample.values[METRIC_LATENCY_LATEST_MS], 0)
+        << std::setw(12) << Cell(sample.values[METRIC_KEYS], 0);
+    if (!endpoint.empty())
+        out << "  " << endpoint;
+    if (sample.missing)
+        out << "  (no reply)";
+    out << std::endl;
+}
+
+void MetricsWriter::WriteNdjson(std::ostream& out, const std::string& endpoint, const MetricsHistory& history)
+{
+    const MetricsSample& sample = history.Newest();
+
+    out << "{\"time\":";
+    WriteJsonNumber(out, sample.timestamp);
+    out << ",\"endpoint\":";
+    WriteJsonString(out, endpoint);
+    out << ",\"up\":" << (sample.missing ? "false" : "true");
+
+    out << ",\"metrics\":{";
+    for (int metric = 0; metric < METRIC_COUNT; ++metric)
+    {
+        if (metric)
+            out << ",";
+        out << "\"" << GetMetricName(static_cast<Metric>(metric)) << "\":";
+        WriteJsonNumber(out, sample.values[metric]);
+    }
+    out << "}";
+
+    // The first sample has nothing to compare to.
+    if (history.Size() > 1)
+    {
+        out << ",\"rates\":";
+        WriteJsonRates(out, MetricsRates::Compute(history.Newest(1), sample));
+        out << ",\"window_seconds\":";
+        WriteJsonNumber(out, sample.timestamp - history.Oldest().timestamp);
+        out << ",\"window_rates\":";
+        WriteJsonRates(out, MetricsRates::Compute(history.Oldest(), sample));
+    }
+    else
+        out << ",\"rates\":null,\"window_seconds\":null,\"window_rates\":null";
+    out << "}" << std::endl;
+}
+
+void MetricsWriter::WriteJsonString(std::ostream& out, const std::string& str)
+{
+    out << '"';
+    for (std::string::const_iterator itr = str.begin(); itr != str.end(); ++itr)
+    {
+        unsigned char c = static_cast<unsigned char>(*itr);
+        if (c == '"' || c == '\\')
+            out << '\\' << *itr;
+        else if (c < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast<int>(c) << std::dec << std::setfill(' ');
+        else
+            out << *itr;
+    }
+    out << '"';
+}
+
+void MetricsWriter::WriteJsonNumber(std::ostream& out, double value)
+{
+    // NaN and infinity aren't valid JSON, value - value is NaN for both.
+    if (value - value != 0)
+    {
+        out << "null";
+        return;
+    }
+    std::streamsize precision = out.precision(15);
+    out << value;
+    out.precision(precision);
+}
+
+void MetricsWriter::WriteJsonRates(std::ostream& out, const MetricsRates& rates)
+{
+    out << "{\"ops_per_sec\":";
+    WriteJsonNumber(out, rates.opsPerSec);
+    out << ",\"hit_ratio\":";
+    WriteJsonNumber(out, rates.hitRatio);
+    out << ",\"evictions_per_sec\":";
+    WriteJsonNumber(out, rates.evictionsPerSec);
+    out << ",\"expirations_per_sec\":";
+    WriteJsonNumber(out, rates.expirationsPerSec);
+    out << ",\"net_input_bytes_per_sec\":";
+    WriteJsonNumber(out, rates.netInputPerSec);
+    out << ",\"net_output_bytes_per_sec\":";
+    WriteJsonNumber(out, rates.netOutputPerSec);
+    out << ",\"usec_per_call\":";
+    WriteJsonNumber(out, rates.usecPerCall);
+    out << "}";
+}
+
+std::string MetricsWriter::Cell(double value, int precision, double scale)
+{
+    std::ostringstream ss;
+    if (value != value)
+        ss << "-";
+    else
+        ss << std::fixed << std::setprecision(precision) << value / scale;
+    return ss.str();
+}
+
+}
@@ -0,0 +1,92 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "MetricsSample.h"
+
+namespace redisCliCs
+{
+
+/**
+ * @brief Writes the samples of the metrics sampler as table rows or as JSON lines.
+ */
+class MetricsWriter
+{
+public:
+    /**
+     * @brief Writes the header of the table.
+     *
+     * @param out          Output.
+     * @param withEndpoint True if the rows have an endpoint column.
+     */
+    static void WriteTableHeader(std::ostream& out, bool withEndpoint);
+    /**
+     * @brief Writes the newest sample of an endpoint as a table row.
+     *
+     * @param out      Output.
+     * @param endpoint Name of the endpoint, empty string omits the endpoint column.
+     * @param history  The samples of the endpoint, must not be empty.
+     */
+    static void WriteTableRow(std::ostream& out, const std::string& endpoint, const MetricsHistory& history);
+    /**
+     * @brief Writes the newest sample of an endpoint as one JSON object in one line.
+     *
+     * The object has the raw metrics, the rates since the previous sample and
+     * the rates over the whole history. The missing values are null.
+     *
+     * @param out      Output.
+     * @param endpoint Name of the endpoint.
+     * @param history  The samples of the endpoint, must not be empty.
+     */
+    static void WriteNdjson(std::ostream& out, const std::string& endpoint, const MetricsHistory& history);
+
+    /**
+     * @brief Writes a JSON string, escapes the quotes, the backslashes and the control characters.
+     */
+    static void WriteJsonString(std::ostream& out, const std::string& str);
+    /**
+     * @brief Writes a JSON number, NaN and infinity are written as null.
+     */
+    static void WriteJsonNumber(std::ostream& out, double value);
+
+private:
+    /**
+     * @brief Writes the rates as a JSON object.
+     */
+    static void WriteJsonRates(std::ostream& out, const MetricsRates& rates);
+    /**
+     * @brief Formats a table cell, NaN is shown as "-".
+     *
+     * @param value     The value.
+     * @param precision Number of the decimals.
+     * @param scale     The value is divided by this.
+     */
+    static std::string Cell(double value, int precision, double scale = 1);
+};
+
+}
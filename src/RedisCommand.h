@@ -0,0 +1,71 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+namespace redisCliCs
+{
+
+/**
+ * @brief Builds the arguments of a Redis command.
+ *
+ * Usage: RedisCommand("SCAN") << cursor << "COUNT" << 1000
+ */
+class RedisCommand
+{
+public:
+    explicit RedisCommand(const std::string& name) : _args(1, name) {}
+
+    RedisCommand& operator<<(const std::string& arg)
+    {
+        _args.push_back(arg);
+        return *this;
+    }
+
+    RedisCommand& operator<<(const char* arg)
+    {
+        _args.push_back(arg);
+        return *this;
+    }
+
+    RedisCommand& operator<<(long long arg)
+    {
+        std::ostringstream ss;
+        ss << arg;
+        _args.push_back(ss.str());
+        return *this;
+    }
+
+    const std::vector<std::string>& GetArgs() const { return _args; }
+
+private:
+    /// The command name followed by its arguments.
+    std::vector<std::string> _args;
+};
+
+}
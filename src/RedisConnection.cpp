@@ -0,0 +1,448 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "RedisConnection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace redisCliCs
+{
+
+RedisConnection::RedisConnection() : _timeoutMs(0),
+                                     _deadline(0),
+                                     _socket(-1),
+                                     _outputBuffer(""),
+                                     _inputBuffer(""),
+                                     _inputPos(0)
+{
+}
+
+RedisConnection::~RedisConnection()
+{
+    Close();
+}
+
+void RedisConnection::Connect(const std::string& hostname, uint16_t port)
+{
+    Close();
+
+    std::ostringstream portStr;
+    portStr << port;
+
+    struct addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* addresses = NULL;
+    int error = getaddrinfo(hostname.c_str(), portStr.str().c_str(), &hints, &addresses);
+    if (error)
+        throw ConnectionException("Can't resolve " + hostname + ": " + gai_strerror(error));
+
+    // Tries all the resolved addresses until one accepts the connection.
+    std::string lastError = "no address";
+    bool timedOut = false;
+    for (struct addrinfo* address = addresses; address; address = address->ai_next)
+    {
+        int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd < 0)
+        {
+            lastError = std::strerror(errno);
+            continue;
+        }
+        int connectError = ConnectSocket(fd, address->ai_addr, address->ai_addrlen);
+        if (connectError)
+        {
+            timedOut = connectError == ETIMEDOUT;
+            lastError = std::strerror(connectError);
+            close(fd);
+            continue;
+        }
+        // Pipelined batches are flushed at once, so Nagle only adds latency.
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        _socket = fd;
+        break;
+    }
+    freeaddrinfo(addresses);
+
+    if (_socket < 0)
+    {
+        // IPv6 literals are bracketed, so the port is readable.
+        std::string endpoint = hostname.find(':') == std::string::npos ? hostname : "[" + hostname + "]";
+        if (timedOut)
+            throw TimeoutException("Can't connect to " + endpoint + ":" + portStr.str() + ": " + lastError);
+        throw ConnectionException("Can't connect to " + endpoint + ":" + portStr.str() + ": " + lastError);
+    }
+}
+
+void RedisConnection::Connect(const RedisConnectionString& cs)
+{
+    Connect(cs.GetEffectiveHostname(), cs.GetEffectivePort());
+    if (!cs.GetPassword().empty())
+        Auth(cs.GetUsername(), cs.GetPassword());
+}
+
+void RedisConnection::Close()
+{
+    if (_socket >= 0)
+        close(_socket);
+    _socket = -1;
+    _outputBuffer.clear();
+    _inputBuffer.clear();
+    _inputPos = 0;
+}
+
+void RedisConnection::Auth(const std::string& username, const std::string& password)
+{
+    RedisCommand command("AUTH");
+    if (!username.empty())
+        command << username;
+    command << password;
+
+    RedisReply reply = Command(command);
+    if (reply.IsError())
+        throw ReplyErrorException(reply.GetString());
+}
+
+void RedisConnection::Select(int db)
+{
+    RedisReply reply = Command(RedisCommand("SELECT") << static_cast<long long>(db));
+    if (reply.IsError())
+        throw ReplyErrorException(reply.GetString());
+}
+
+void RedisConnection::AppendCommand(const RedisCommand& command)
+{
+    const std::vector<std::string>& args = command.GetArgs();
+
+    std::ostringstream ss;
+    ss << "*" << args.size() << "\r\n";
+    for (std::vector<std::string>::const_iterator itr = args.begin(); itr != args.end(); ++itr)
+        ss << "$" << itr->length() << "\r\n" << *itr << "\r\n";
+    _outputBuffer += ss.str();
+}
+
+void RedisConnection::Flush()
+{
+    if (_socket < 0)
+        throw ConnectionException("Not connected.");
+
+    StartDeadline();
+    std::size_t written = 0;
+    while (written < _outputBuffer.length())
+    {
+        Wait(POLLOUT);
+        // Doesn't block when there is a timeout, Wait() does the waiting.
+        ssize_t n = send(_socket, _outputBuffer.data() + written, _outputBuffer.length() - written,
+                         MSG_NOSIGNAL | (_timeoutMs ? MSG_DONTWAIT : 0));
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            throw ConnectionException(std::string("Write error: ") + std::strerror(errno));
+        }
+        written += n;
+    }
+    _outputBuffer.clear();
+}
+
+RedisReply RedisConnection::ReadReply()
+{
+    StartDeadline();
+    return ParseReply();
+}
+
+bool RedisConnection::HasReply() const
+{
+    std::size_t pos = _inputPos;
+    return ScanReply(pos);
+}
+
+void RedisConnection::ReadAvailable()
+{
+    StartDeadline();
+    Fill();
+}
+
+RedisReply RedisConnection::ParseReply()
+{
+    std::string line = ReadLine();
+    if (line.empty())
+        throw ProtocolException("empty reply header");
+
+    RedisReply reply;
+    std::string payload = line.substr(1);
+    switch (line[0])
+    {
+        case '+':
+            reply.SetType(RedisReply::REPLY_STATUS);
+            reply.SetString(payload);
+            break;
+        case '-':
+            reply.SetType(RedisReply::REPLY_ERROR);
+            reply.SetString(payload);
+            break;
+        case ':':
+            reply.SetType(RedisReply::REPLY_INTEGER);
+            reply.SetInteger(ParseInteger(payload));
+            break;
+        case '$':
+        {
+            long long length = ParseInteger(payload);
+            // Null bulk string.
+            if (length < 0)
+                break;
+            if (length > REDIS_MAX_BULK_LENGTH)
+                throw ProtocolException("bulk string length " + payload + " exceeds the limit");
+            reply.SetType(RedisReply::REPLY_STRING);
+            reply.SetString(ReadBytes(length));
+            // The trailing CRLF.
+            if (!ReadLine().empty())
+                throw ProtocolException("bulk string length mismatch");
+            break;
+        }
+        case '*':
+        {
+            long long count = ParseInteger(payload);
+            // Null array.
+            if (count < 0)
+                break;
+            if (count > REDIS_MAX_ARRAY_LENGTH)
+                throw ProtocolException("array length " + payload + " exceeds the limit");
+            reply.SetType(RedisReply::REPLY_ARRAY);
+            // Only a few elements are reserved, the rest is allocated as they arrive.
+            reply.GetElements().reserve(std::min(count, static_cast<long long>(REDIS_MAX_ARRAY_RESERVE)));
+            for (long long i = 0; i < count; ++i)
+                reply.GetElements().push_back(ParseReply());
+            break;
+        }
+        default:
+            throw ProtocolException("unknown reply type '" + line.substr(0, 1) + "'");
+    }
+    return reply;
+}
+
+RedisReply RedisConnection::Command(const RedisCommand& command)
+{
+    AppendCommand(command);
+    Flush();
+    return ReadReply();
+}
+
+bool RedisConnection::ScanReply(std::size_t& pos) const
+{
+    std::size_t crlfPos = _inputBuffer.find("\r\n", pos);
+    // No whole line yet. A too long one counts as malformed, ReadLine() throws without reading more.
+    if (crlfPos == std::string::npos)
+        return _inputBuffer.length() - pos > REDIS_MAX_LINE_LENGTH;
+    if (crlfPos == pos)
+        return true;
+
+    char type = _inputBuffer[pos];
+    std::string payload = _inputBuffer.substr(pos + 1, crlfPos - pos - 1);
+    pos = crlfPos + 2;
+    if (type != '$' && type != '*')
+        return true;
+
+    char* end = NULL;
+    long long length = std::strtoll(payload.c_str(), &end, 10);
+    // Malformed, null or too long.
+    if (payload.empty() || *end != '\0' || length < 0 ||
+        length > (type == '$' ? REDIS_MAX_BULK_LENGTH : REDIS_MAX_ARRAY_LENGTH))
+        return true;
+
+    if (type == '$')
+    {
+        // The string and its CRLF.
+        if (_inputBuffer.length() - pos < static_cast<unsigned long long>(length) + 2)
+            return false;
+        pos += length + 2;
+        return true;
+    }
+    for (long long i = 0; i < length; ++i)
+        if (!ScanReply(pos))
+            return false;
+    return true;
+}
+
+void RedisConnection::StartDeadline()
+{
+    if (_timeoutMs)
+        _deadline = Now() + _timeoutMs;
+}
+
+void RedisConnection::Wait(short events) const
+{
+    if (!_timeoutMs)
+        return;
+
+    struct pollfd pfd;
+    pfd.fd = _socket;
+    pfd.events = events;
+    pfd.revents = 0;
+    for (;;)
+    {
+        double remaining = _deadline - Now();
+        int ready = remaining > 0 ? poll(&pfd, 1, static_cast<int>(remaining) + 1) : 0;
+        if (ready < 0 && errno == EINTR)
+            continue;
+        // An error or a hangup is reported by the next recv() or send().
+        if (ready != 0)
+            return;
+        throw TimeoutException(events == POLLOUT ? "Write timed out." : "Read timed out.");
+    }
+}
+
+double RedisConnection::Now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+std::string RedisConnection::ReadLine()
+{
+    // Number of bytes after the read position which are already known to not contain CRLF.
+    std::size_t scanned = 0;
+    for (;;)
+    {
+        std::size_t crlfPos = _inputBuffer.find("\r\n", _inputPos + scanned);
+        if (crlfPos != std::string::npos)
+        {
+            std::string line = _inputBuffer.substr(_inputPos, crlfPos - _inputPos);
+            _inputPos = crlfPos + 2;
+            return line;
+        }
+        // The CR may be the last byte of the buffer, so don't skip it.
+        scanned = _inputBuffer.length() - _inputPos;
+        if (scanned > REDIS_MAX_LINE_LENGTH)
+            throw ProtocolException("line exceeds the limit");
+        if (scanned > 0)
+            --scanned;
+        Fill();
+    }
+}
+
+std::string RedisConnection::ReadBytes(std::size_t length)
+{
+    while (_inputBuffer.length() - _inputPos < length)
+        Fill();
+    std::string bytes = _inputBuffer.substr(_inputPos, length);
+    _inputPos += length;
+    return bytes;
+}
+
+void RedisConnection::Fill()
+{
+    if (_socket < 0)
+        throw ConnectionException("Not connected.");
+
+    // Drops the already parsed data, so the buffer doesn't grow forever.
+    if (_inputPos > 0)
+    {
+        _inputBuffer.erase(0, _inputPos);
+        _inputPos = 0;
+    }
+
+    char chunk[REDIS_CONNECTION_READ_CHUNK_SIZE];
+    for (;;)
+    {
+        Wait(POLLIN);
+        // Doesn't block when there is a timeout, Wait() does the waiting.
+        ssize_t n = recv(_socket, chunk, sizeof(chunk), _timeoutMs ? MSG_DONTWAIT : 0);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+            continue;
+        if (n < 0)
+            throw ConnectionException(std::string("Read error: ") + std::strerror(errno));
+        if (n == 0)
+            throw ConnectionException("Connection closed by the server.");
+        _inputBuffer.append(chunk, n);
+        return;
+    }
+}
+
+int RedisConnection::ConnectSocket(int fd, const struct sockaddr* address, socklen_t addressLength) const
+{
+    if (!_timeoutMs)
+        return connect(fd, address, addressLength) < 0 ? errno : 0;
+
+    // Connects in non-blocking mode, so the wait can be limited with poll().
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    int error = 0;
+    if (connect(fd, address, addressLength) < 0)
+    {
+        error = errno;
+        if (error == EINPROGRESS)
+        {
+            struct pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            int ready;
+            while ((ready = poll(&pfd, 1, static_cast<int>(_timeoutMs))) < 0 && errno == EINTR)
+                ;
+            if (ready == 0)
+                error = ETIMEDOUT;
+            else if (ready < 0)
+                error = errno;
+            else
+            {
+                socklen_t errorLength = sizeof(error);
+                if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLength) < 0)
+                    error = errno;
+            }
+        }
+    }
+    fcntl(fd, F_SETFL, flags);
+    return error;
+}
+
+long long RedisConnection::ParseInteger(const std::string& str)
+{
+    if (str.empty())
+        throw ProtocolException("empty integer");
+    char* end = NULL;
+    long long value = std::strtoll(str.c_str(), &end, 10);
+    if (*end != '\0')
+        throw ProtocolException("invalid integer '" + str + "'");
+    return value;
+}
+
+}
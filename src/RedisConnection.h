@@ -0,0 +1,283 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <stdexcept>
+
+#include <sys/socket.h>
+
+#include "RedisCommand.h"
+#include "RedisConnectionString.h"
+#include "RedisReply.h"
+
+namespace redisCliCs
+{
+
+/// Size of a single read from the socket.
+#define REDIS_CONNECTION_READ_CHUNK_SIZE 16384
+/// Maximum length of a bulk string reply, the default proto-max-bulk-len of Redis (512 MB).
+#define REDIS_MAX_BULK_LENGTH (512LL * 1024 * 1024)
+/// Maximum number of elements of an array reply.
+#define REDIS_MAX_ARRAY_LENGTH (1024LL * 1024 * 1024)
+/// Maximum length of a reply header or status line, the inline limit of Redis (64 KB).
+#define REDIS_MAX_LINE_LENGTH (64 * 1024)
+/// Maximum number of array elements which are reserved before they arrive.
+#define REDIS_MAX_ARRAY_RESERVE 1024
+
+/**
+ * @brief A blocking connection to a Redis server which speaks RESP2.
+ *
+ * Commands can be pipelined: append any number of commands, flush them
+ * with a single write, then read the replies in the same order.
+ */
+class RedisConnection
+{
+public:
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        connection to the Redis server can't be established or is lost.
+     */
+    class ConnectionException : public std::runtime_error
+    {
+    public:
+        ConnectionException(const std::string& message) : std::runtime_error(message) {}
+    };
+
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        Redis server doesn't answer within the timeout.
+     */
+    class TimeoutException : public ConnectionException
+    {
+    public:
+        TimeoutException(const std::string& message) : ConnectionException(message) {}
+    };
+
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        Redis server sends something that isn't valid RESP2.
+     */
+    class ProtocolException : public std::runtime_error
+    {
+    public:
+        ProtocolException(const std::string& message) : std::runtime_error("Redis protocol error: " + message) {}
+    };
+
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        Redis server replies with an error to a command which must succeed.
+     */
+    class ReplyErrorException : public std::runtime_error
+    {
+    public:
+        ReplyErrorException(const std::string& message) : std::runtime_error("Redis error: " + message) {}
+    };
+
+public:
+    RedisConnection();
+    ~RedisConnection();
+
+    /**
+     * @brief Sets the timeout of connecting, of every Flush() and of every ReadReply().
+     *        A reply which arrives in small pieces still has to arrive in time.
+     *
+     * @param timeoutMs The timeout in milliseconds, 0 means no timeout (the default).
+     */
+    void SetTimeout(std::size_t timeoutMs) { _timeoutMs = timeoutMs; }
+    /**
+     * @brief Checks whether the connection is open.
+     */
+    bool IsConnected() const { return _socket >= 0; }
+    /**
+     * @brief Gets the file descriptor of the socket, -1 when not connected.
+     *        It's for waiting on several connections with poll().
+     */
+    int GetSocket() const { return _socket; }
+
+    /**
+     * @brief Connects to a Redis server.
+     *
+     * @param hostname Hostname (or IP address) of the Redis server.
+     * @param port     Port of the Redis server.
+     *
+     * @throws ConnectionException When the connection can't be established.
+     * @throws TimeoutException    When connecting takes longer than the timeout.
+     */
+    void Connect(const std::string& hostname, uint16_t port);
+    /**
+     * @brief Connects to the Redis server of a connection string and
+     *        authenticates if the connection string has a password.
+     *        The path (DB) isn't selected.
+     *
+     * @param cs The connection string.
+     *
+     * @throws ConnectionException When the connection can't be established.
+     * @throws ReplyErrorException When the authentication fails.
+     */
+    void Connect(const RedisConnectionString& cs);
+    /**
+     * @brief Closes the connection, if it is open.
+     */
+    void Close();
+
+    /**
+     * @brief Authenticates the connection.
+     *
+     * @param username Username, may be empty string (legacy password only AUTH).
+     * @param password Password.
+     *
+     * @throws ReplyErrorException When the authentication fails.
+     */
+    void Auth(const std::string& username, const std::string& password);
+    /**
+     * @brief Selects a DB on the connection.
+     *
+     * @param db Index of the DB.
+     *
+     * @throws ReplyErrorException When the DB can't be selected.
+     */
+    void Select(int db);
+
+    /**
+     * @brief Appends a command to the output buffer, doesn't send it.
+     *
+     * @param command The command.
+     */
+    void AppendCommand(const RedisCommand& command);
+    /**
+     * @brief Sends all the appended commands to the Redis server.
+     *
+     * @throws ConnectionException When the write fails.
+     * @throws TimeoutException    When the write takes longer than the timeout.
+     */
+    void Flush();
+    /**
+     * @brief Reads the next reply from the Redis server.
+     *
+     * @return The reply.
+     *
+     * @throws ConnectionException When the read fails.
+     * @throws TimeoutException    When the reply doesn't arrive within the timeout.
+     * @throws ProtocolException   When the reply is malformed or exceeds a length limit.
+     */
+    RedisReply ReadReply();
+    /**
+     * @brief Checks whether a whole reply has been received, so ReadReply() doesn't block.
+     *        A malformed reply counts as received, ReadReply() throws its error.
+     */
+    bool HasReply() const;
+    /**
+     * @brief Reads the data which has arrived from the socket to the input buffer,
+     *        blocks if nothing has arrived.
+     *
+     * @throws ConnectionException When the read fails.
+     * @throws TimeoutException    When no data arrives within the timeout.
+     */
+    void ReadAvailable();
+
+    /**
+     * @brief Sends a command and waits for its reply.
+     *
+     * @param command The command.
+     * @return        The reply, may be an error reply.
+     */
+    RedisReply Command(const RedisCommand& command);
+
+private:
+    RedisConnection(const RedisConnection&);
+    RedisConnection& operator=(const RedisConnection&);
+
+    /**
+     * @brief Reads the next reply, or an element of an array reply, until the deadline.
+     */
+    RedisReply ParseReply();
+    /**
+     * @brief Checks whether a whole reply is in the input buffer from the given position.
+     *
+     * @param pos Position of the reply, moved after it if it's whole.
+     * @return    True if the reply is whole or malformed.
+     */
+    bool ScanReply(std::size_t& pos) const;
+    /**
+     * @brief Starts the deadline of a read or a write, if there is a timeout.
+     */
+    void StartDeadline();
+    /**
+     * @brief Waits until the socket is ready for the given poll() events,
+     *        returns at once if there is no timeout.
+     *
+     * @throws TimeoutException When the deadline passes.
+     */
+    void Wait(short events) const;
+    /**
+     * @brief Gets the monotonic time in milliseconds.
+     */
+    static double Now();
+    /**
+     * @brief Reads a CRLF terminated line from the input buffer,
+     *        reads from the socket while the line isn't complete.
+     *
+     * @return The line without the CRLF.
+     */
+    std::string ReadLine();
+    /**
+     * @brief Reads exactly the given number of bytes from the input buffer,
+     *        reads from the socket while not enough data is available.
+     *
+     * @param length Number of bytes.
+     * @return       The bytes.
+     */
+    std::string ReadBytes(std::size_t length);
+    /**
+     * @brief Reads some data from the socket to the input buffer.
+     */
+    void Fill();
+    /**
+     * @brief Parses an integer from a reply header line.
+     */
+    static long long ParseInteger(const std::string& str);
+    /**
+     * @brief Connects a socket, waits at most _timeoutMs if it isn't 0.
+     *
+     * @return 0 on success, or else the errno value.
+     */
+    int ConnectSocket(int fd, const struct sockaddr* address, socklen_t addressLength) const;
+
+    /// Timeout of connecting, reading and writing in milliseconds, 0 means no timeout.
+    std::size_t _timeoutMs;
+    /// Monotonic time in milliseconds when the current read or write times out.
+    double _deadline;
+    /// File descriptor of the socket, -1 when not connected.
+    int _socket;
+    /// Commands which are appended but not sent yet.
+    std::string _outputBuffer;
+    /// Received but not yet parsed data.
+    std::string _inputBuffer;
+    /// Position of the first not yet parsed byte in the input buffer.
+    std::size_t _inputPos;
+};
+
+}
@@ -25,12 +25,28 @@
 #pragma once
 
 #include <string>
+#include <sstream>
+#include <stdint.h>
+
+#include "Hash.h"
 
 namespace redisCliCs
 {
 
+/// Hostname of the Redis server when the connection string doesn't have one, same as redis-cli's.
+#define REDIS_DEFAULT_HOSTNAME "127.0.0.1"
+/// Port of the Redis server when the connection string doesn't have one.
+#define REDIS_DEFAULT_PORT 6379
+/// Port value which means that the connection string doesn't have a port.
+#define REDIS_NO_PORT 0
+/// DB index value which means that the connection string doesn't have a path.
+#define REDIS_NO_DB -1
+
 /**
  * @brief Represents a parsed Redis connection string (URI).
+ *
+ * The endpoint hash is recomputed by the setters, so it's always up to date
+ * and reading it is free.
  */
 class RedisConnectionString
 {
@@ -39,40 +55,108 @@ public:
                               _username(""),
                               _password(""),
                               _hostname(""),
-                              _port(""),
-                              _path("") {}
+                              _port(REDIS_NO_PORT),
+                              _db(REDIS_NO_DB),
+                              _endpointHash(0),
+                              _serverHash(0)
+    {
+        UpdateEndpointHash();
+    }
 
     std::string GetSchemeName() const { return _schemeName; }
     void SetSchemeName(std::string schemeName) { _schemeName = schemeName; }
 
     std::string GetUsername() const { return _username; }
-    void SetUsername(std::string username) { _username = username; }
+    void SetUsername(std::string username) { _username = username; UpdateEndpointHash(); }
 
     std::string GetPassword() const { return _password; }
-    void SetPassword(std::string password) { _password = password; }
+    void SetPassword(std::string password) { _password = password; UpdateEndpointHash(); }
 
+    /// Hostname, an IPv6 literal is stored without its brackets.
     std::string GetHostname() const { return _hostname; }
-    void SetHostname(std::string hostname) { _hostname = hostname; }
+    void SetHostname(std::string hostname) { _hostname = hostname; UpdateEndpointHash(); }
+    /// The hostname, or REDIS_DEFAULT_HOSTNAME if there isn't one.
+    std::string GetEffectiveHostname() const { return _hostname.empty() ? REDIS_DEFAULT_HOSTNAME : _hostname; }
 
-    std::string GetPort() const { return _port; }
-    void SetPort(std::string port) { _port = port; }
+    /// Port, REDIS_NO_PORT if there isn't one.
+    uint16_t GetPort() const { return _port; }
+    void SetPort(uint16_t port) { _port = port; UpdateEndpointHash(); }
+    bool HasPort() const { return _port != REDIS_NO_PORT; }
+    /// The port, or REDIS_DEFAULT_PORT if there isn't one.
+    uint16_t GetEffectivePort() const { return HasPort() ? _port : REDIS_DEFAULT_PORT; }
 
-    std::string GetPath() const { return _path; }
-    void SetPath(std::string path) { _path = path; }
+    /// DB index (the path), REDIS_NO_DB if there isn't one.
+    int GetDb() const { return _db; }
+    void SetDb(int db) { _db = db; UpdateEndpointHash(); }
+    bool HasDb() const { return _db != REDIS_NO_DB; }
+
+    /**
+     * @brief Gets the effective hostname and port, like 127.0.0.1:6379 or [::1]:6379.
+     */
+    std::string GetEndpointName() const
+    {
+        std::ostringstream ss;
+        std::string hostname = GetEffectiveHostname();
+        if (hostname.find(':') != std::string::npos)
+            ss << "[" << hostname << "]";
+        else
+            ss << hostname;
+        ss << ":" << GetEffectivePort();
+        return ss.str();
+    }
+
+    /**
+     * @brief Gets the 64-bit hash of the endpoint: the effective hostname (case insensitive,
+     *        except the zone ID of an IPv6 address, the parser stores the addresses canonical),
+     *        the effective port, the DB index and the credentials. Connection strings which
+     *        would open interchangeable connections have the same hash, so it can be used as
+     *        the key of connection pools and dedup caches.
+     */
+    uint64_t GetEndpointHash() const { return _endpointHash; }
+    /**
+     * @brief Gets the 64-bit hash of the server: the effective hostname (case insensitive
+     *        as in GetEndpointHash()) and the effective port only. Connection strings which differ only in the DB
+     *        or the credentials have the same hash, use it to dedup server wide data like INFO.
+     */
+    uint64_t GetServerHash() const { return _serverHash; }
 
 private:
+    /**
+     * @brief Recomputes the endpoint and the server hashes.
+     */
+    void UpdateEndpointHash()
+    {
+        std::ostringstream key;
+        std::string hostname = GetEffectiveHostname();
+        // The zone ID of an IPv6 address is an interface name, which is case sensitive.
+        for (std::string::iterator itr = hostname.begin(); itr != hostname.end() && *itr != '%'; ++itr)
+            if (*itr >= 'A' && *itr <= 'Z')
+                *itr = *itr - 'A' + 'a';
+        // The fields are separated by NUL, which can't be in a hostname, so the key is unambiguous
+        // except for the credentials, whose lengths are prefixed.
+        key << hostname << '\0' << GetEffectivePort() << '\0';
+        _serverHash = Fnv1a64(key.str());
+        key << (HasDb() ? _db : 0) << '\0'
+            << _username.length() << '\0' << _username << _password.length() << '\0' << _password;
+        _endpointHash = Fnv1a64(key.str());
+    }
+
     /// Scheme name of the connection string.
     std::string _schemeName;
-    /// Username.
+    /// Username, percent-decoded.
     std::string _username;
-    /// Password.
+    /// Password, percent-decoded.
     std::string _password;
-    /// Hostname (or IP address).
+    /// Hostname (or IP address), an IPv6 literal is stored without its brackets.
     std::string _hostname;
-    /// Port.
-    std::string _port;
-    /// Path which is a DB index in Redis.
-    std::string _path;
+    /// Port, REDIS_NO_PORT if there isn't one.
+    uint16_t _port;
+    /// DB index (the path), REDIS_NO_DB if there isn't one.
+    int _db;
+    /// Hash of the endpoint, see GetEndpointHash().
+    uint64_t _endpointHash;
+    /// Hash of the server, see GetServerHash().
+    uint64_t _serverHash;
 };
 
 }
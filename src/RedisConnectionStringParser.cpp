@@ -24,6 +24,12 @@
 
 #include "RedisConnectionStringParser.h"
 
+#include <climits>
+#include <cstdlib>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
 namespace redisCliCs
 {
 
@@ -46,18 +52,21 @@ RedisConnectionString RedisConnectionStringParser::Parse(std::string connectionS
 
     // Gets the userinfo part of the connection string.
     std::string connectionStringUserInfo = GetUserInfo(connectionStringWithoutScheme);
-    cs.SetUsername(GetUsername(connectionStringUserInfo));
-    cs.SetPassword(GetPassword(connectionStringUserInfo));
+    cs.SetUsername(PercentDecode(GetUsername(connectionStringUserInfo), "username"));
+    cs.SetPassword(PercentDecode(GetPassword(connectionStringUserInfo), "password"));
 
     // Gets the hostname + port + path part of the connection string.
     std::string hostnamePortPath = GetHostnamePortPath(connectionStringWithoutScheme);
     // Gets the hostname + port part of the connection string.
     std::string hostnamePort = GetHostnamePort(hostnamePortPath);
 
-    cs.SetHostname(GetHostname(hostnamePort));
-    cs.SetPort(GetPort(hostnamePort));
+    std::string hostname;
+    std::string port;
+    SplitHostnamePort(hostnamePort, hostname, port);
+    cs.SetHostname(ParseHostname(hostname));
+    cs.SetPort(ParsePort(port));
 
-    cs.SetPath(GetPath(hostnamePortPath));
+    cs.SetDb(ParseDb(GetPath(hostnamePortPath)));
 
     return cs;
 }
@@ -124,24 +133,107 @@ std::string RedisConnectionStringParser::GetHostnamePort(std::string hostnamePor
     return hostnamePortPath.substr(0, pathSeparatorPos);
 }
 
-std::string RedisConnectionStringParser::GetHostname(std::string hostnamePort)
+void RedisConnectionStringParser::SplitHostnamePort(std::string hostnamePort, std::string& hostname, std::string& port)
 {
-    // Gets the first position of the port separator.
-    std::size_t hostnameSeparatorPos = hostnamePort.find_first_of(URI_PORT_SEPARATOR);
+    std::size_t portSeparatorPos;
+    // Not an IPv6 literal, so the first port separator ends the hostname.
+    if (hostnamePort.compare(0, std::string(URI_IPV6_OPEN).length(), URI_IPV6_OPEN))
+    {
+        portSeparatorPos = hostnamePort.find_first_of(URI_PORT_SEPARATOR);
+        // More port separators, it may be an IPv6 address (with or without a port) without the brackets.
+        if (portSeparatorPos != std::string::npos &&
+            hostnamePort.find_first_of(URI_PORT_SEPARATOR, portSeparatorPos + 1) != std::string::npos &&
+            (IsIpv6Address(hostnamePort) ||
+             IsIpv6Address(hostnamePort.substr(0, hostnamePort.find_last_of(URI_PORT_SEPARATOR)))))
+            throw InvalidHostnameException(hostnamePort, "IPv6 addresses have to be bracketed");
+    }
+    else
+    {
+        // Gets the position of the closing bracket, the port separator may only follow it.
+        std::size_t ipv6ClosePos = hostnamePort.find_first_of(URI_IPV6_CLOSE);
+        if (ipv6ClosePos == std::string::npos)
+            throw InvalidHostnameException(hostnamePort, "unclosed bracket");
+
+        portSeparatorPos = ipv6ClosePos + std::string(URI_IPV6_CLOSE).length();
+        // No port.
+        if (portSeparatorPos == hostnamePort.length())
+            portSeparatorPos = std::string::npos;
+        // Something else than a port after the closing bracket.
+        else if (hostnamePort.compare(portSeparatorPos, std::string(URI_PORT_SEPARATOR).length(), URI_PORT_SEPARATOR))
+            throw InvalidHostnameException(hostnamePort, "only a port may follow the closing bracket");
+    }
+
     // No separator, so no port, so the hostname is the full hostname + port string.
-    if (hostnameSeparatorPos == std::string::npos)
-        return hostnamePort;
-    return hostnamePort.substr(0, hostnameSeparatorPos);
+    if (portSeparatorPos == std::string::npos)
+    {
+        hostname = hostnamePort;
+        port = "";
+        return;
+    }
+    hostname = hostnamePort.substr(0, portSeparatorPos);
+    port = hostnamePort.substr(portSeparatorPos + std::string(URI_PORT_SEPARATOR).length());
 }
 
-std::string RedisConnectionStringParser::GetPort(std::string hostnamePort)
+std::string RedisConnectionStringParser::ParseHostname(std::string hostname)
 {
-    // Gets the first position of the port separator.
-    std::size_t hostnameSeparatorPos = hostnamePort.find_first_of(URI_PORT_SEPARATOR);
-    // No separator, so no port.
-    if (hostnameSeparatorPos == std::string::npos)
-        return "";
-    return hostnamePort.substr(hostnameSeparatorPos + std::string(URI_PORT_SEPARATOR).length());
+    if (!hostname.compare(0, std::string(URI_IPV6_OPEN).length(), URI_IPV6_OPEN))
+    {
+        // Removes the brackets, SplitHostnamePort() checked that they are there.
+        std::string literal = hostname.substr(std::string(URI_IPV6_OPEN).length(),
+                                              hostname.length() - std::string(URI_IPV6_OPEN).length() - std::string(URI_IPV6_CLOSE).length());
+
+        // An optional zone ID (RFC 6874) follows the address, like fe80::1%25eth0.
+        std::size_t zonePos = literal.find(URI_IPV6_ZONE_SEPARATOR);
+        // Stores the canonical form (RFC 5952), so the spellings of an address compare equal.
+        struct in6_addr parsed;
+        char canonical[INET6_ADDRSTRLEN];
+        if (inet_pton(AF_INET6, literal.substr(0, zonePos).c_str(), &parsed) != 1 ||
+            !inet_ntop(AF_INET6, &parsed, canonical, sizeof(canonical)))
+            throw InvalidHostnameException(hostname, "invalid IPv6 address");
+        std::string address = canonical;
+        if (zonePos == std::string::npos)
+            return address;
+
+        std::string zone = literal.substr(zonePos + std::string(URI_IPV6_ZONE_SEPARATOR).length());
+        if (zone.empty() || zone.find_first_not_of(URI_UNRESERVED_CHARACTERS) != std::string::npos)
+            throw InvalidHostnameException(hostname, "invalid IPv6 zone ID");
+        // getaddrinfo() takes the zone ID after a plain %.
+        return address + "%" + zone;
+    }
+
+    // A registered name (RFC 3986): unreserved characters, sub-delims and percent-encoded bytes of them.
+    std::string decoded;
+    try
+    {
+        decoded = PercentDecode(hostname, "hostname");
+    }
+    catch (const InvalidPercentEncodingException&)
+    {
+        throw InvalidHostnameException(hostname, "invalid percent-encoding");
+    }
+    if (decoded.find_first_not_of(URI_UNRESERVED_CHARACTERS URI_SUB_DELIM_CHARACTERS) != std::string::npos)
+        throw InvalidHostnameException(hostname, "invalid character");
+    return decoded;
+}
+
+bool RedisConnectionStringParser::IsIpv6Address(std::string address)
+{
+    struct in6_addr parsed;
+    return inet_pton(AF_INET6, address.c_str(), &parsed) == 1;
+}
+
+uint16_t RedisConnectionStringParser::ParsePort(std::string port)
+{
+    // No port.
+    if (port.empty())
+        return REDIS_NO_PORT;
+    // At most 5 digits, so it can't overflow.
+    if (port.length() > 5 || port.find_first_not_of("0123456789") != std::string::npos)
+        throw InvalidPortException(port);
+    long value = std::atol(port.c_str());
+    if (value < 1 || value > 65535)
+        throw InvalidPortException(port);
+    return static_cast<uint16_t>(value);
 }
 
 std::string RedisConnectionStringParser::GetPath(std::string hostnamePortPath)
@@ -154,4 +246,40 @@ std::string RedisConnectionStringParser::GetPath(std::string hostnamePortPath)
     return hostnamePortPath.substr(pathSeparatorPos + std::string(URI_PATH_SEPARATOR).length());
 }
 
+int RedisConnectionStringParser::ParseDb(std::string path)
+{
+    // No path, so no DB.
+    if (path.empty())
+        return REDIS_NO_DB;
+    // At most 9 digits, so it can't overflow an int.
+    if (path.length() > 9 || path.find_first_not_of("0123456789") != std::string::npos)
+        throw InvalidDbIndexException(path);
+    return std::atoi(path.c_str());
+}
+
+std::string RedisConnectionStringParser::PercentDecode(std::string str, const std::string& part)
+{
+    std::string decoded;
+    decoded.reserve(str.length());
+    for (std::size_t i = 0; i < str.length(); ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        std::size_t length = 1;
+        if (str[i] == URI_PERCENT_ENCODING)
+        {
+            // A % has to be followed by two hex digits.
+            std::string hex = str.substr(i + 1, 2);
+            if (hex.length() != 2 || hex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+                throw InvalidPercentEncodingException(part, i, "% has to be followed by two hex digits");
+            c = static_cast<unsigned char>(std::strtol(hex.c_str(), NULL, 16));
+            length = 3;
+        }
+        if (c < 0x20 || c == 0x7f)
+            throw InvalidPercentEncodingException(part, i, "control characters aren't allowed");
+        decoded += static_cast<char>(c);
+        i += length - 1;
+    }
+    return decoded;
+}
+
 }
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <sstream>
 #include <string>
 #include <stdexcept>
 
@@ -42,6 +43,18 @@ namespace redisCliCs
 #define URI_PORT_SEPARATOR ":"
 /// Separates the path from the hostname or from the port.
 #define URI_PATH_SEPARATOR "/"
+/// Opens an IPv6 literal hostname.
+#define URI_IPV6_OPEN "["
+/// Closes an IPv6 literal hostname.
+#define URI_IPV6_CLOSE "]"
+/// Separates the zone ID from the address in an IPv6 literal (RFC 6874), it's a percent-encoded %.
+#define URI_IPV6_ZONE_SEPARATOR "%25"
+/// Starts a percent-encoded byte.
+#define URI_PERCENT_ENCODING '%'
+/// The unreserved characters of RFC 3986.
+#define URI_UNRESERVED_CHARACTERS "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._~"
+/// The sub-delims characters of RFC 3986.
+#define URI_SUB_DELIM_CHARACTERS "!$&'()*+,;="
 
 /**
  * @brief Parses a Redis connection string (URI).
@@ -70,6 +83,64 @@ public:
                                                       "with the Redis URI scheme (redis://).") {}
     };
 
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        hostname of the Redis connection string (URI) isn't a
+     *        valid registered name or bracketed IPv6 literal.
+     */
+    class InvalidHostnameException : public std::runtime_error
+    {
+    public:
+        InvalidHostnameException(const std::string& hostname, const std::string& reason) :
+            std::runtime_error("Invalid hostname in the Redis connection string: " + hostname + " (" + reason + ").") {}
+    };
+
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        port of the Redis connection string (URI) isn't a
+     *        number between 1 and 65535.
+     */
+    class InvalidPortException : public std::runtime_error
+    {
+    public:
+        InvalidPortException(const std::string& port) :
+            std::runtime_error("Invalid port in the Redis connection string: " + port + ".") {}
+    };
+
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        path of the Redis connection string (URI) isn't a
+     *        non-negative DB index.
+     */
+    class InvalidDbIndexException : public std::runtime_error
+    {
+    public:
+        InvalidDbIndexException(const std::string& db) :
+            std::runtime_error("Invalid DB index in the Redis connection string: " + db + ".") {}
+    };
+
+    /**
+     * @brief Represents an exception which is thrown when the
+     *        userinfo of the Redis connection string (URI) has
+     *        an invalid percent-encoded byte or a control character.
+     *        The message doesn't contain the value, it may be a password.
+     */
+    class InvalidPercentEncodingException : public std::runtime_error
+    {
+    public:
+        InvalidPercentEncodingException(const std::string& part, std::size_t offset, const std::string& reason) :
+            std::runtime_error("Invalid percent-encoding in the " + part + " of the Redis connection string at offset " +
+                               ToString(offset) + " (" + reason + ").") {}
+
+    private:
+        static std::string ToString(std::size_t value)
+        {
+            std::ostringstream ss;
+            ss << value;
+            return ss.str();
+        }
+    };
+
 public:
     /**
      * @brief Parses the raw Redis connection string (URI) to a structured format.
@@ -78,9 +149,15 @@ public:
      * @return                 The parsed and structured format of the Redis connection
      *                         string (URI), RedisConnectionString.
      *
-     * @throws EmptyParameterException When the Redis connection string (URI) is empty.
-     * @throws NoRedisSchemeException  When the Redis connection string (URI) doesn't have the
-     *                                 proper Redis scheme (redis://).
+     * @throws EmptyParameterException         When the Redis connection string (URI) is empty.
+     * @throws NoRedisSchemeException          When the Redis connection string (URI) doesn't have the
+     *                                         proper Redis scheme (redis://).
+     * @throws InvalidHostnameException        When the hostname isn't a valid registered name or
+     *                                         bracketed IPv6 literal.
+     * @throws InvalidPortException            When the port isn't a number between 1 and 65535.
+     * @throws InvalidDbIndexException         When the path isn't a non-negative DB index.
+     * @throws InvalidPercentEncodingException When the userinfo has an invalid percent-encoded byte
+     *                                         or a control character.
      */
     static RedisConnectionString Parse(std::string connectionString);
 
@@ -117,6 +194,19 @@ private:
      * @return         Pasword of the Redis connection string (URI), may be empty string.
      */
     static std::string GetPassword(std::string userInfo);
+    /**
+     * @brief Decodes the percent-encoded bytes (like %40 to @), rejects the control characters.
+     *        The username and the password end up in commands and command lines,
+     *        where a NUL would cut them short and the other control bytes are never intended.
+     *
+     * @param str  The percent-encoded string.
+     * @param part Name of the part of the connection string for the error message, like "password".
+     * @return     The decoded string.
+     *
+     * @throws InvalidPercentEncodingException When a % isn't followed by two hex digits or
+     *                                         a byte is a control character.
+     */
+    static std::string PercentDecode(std::string str, const std::string& part);
 
     /**
      * @brief Gets hostname, port and path from a Redis connection string (URI) without scheme.
@@ -137,19 +227,41 @@ private:
      */
     static std::string GetHostnamePort(std::string hostnamePortPath);
     /**
-     * @brief Gets the hostname from the hostname + port of the Redis connection string (URI).
+     * @brief Splits the hostname + port of the Redis connection string (URI),
+     *        skips the colons of a bracketed IPv6 literal.
      *
      * @param hostnamePort The hostname + port of the Redis connection string (URI).
-     * @return             Hostname of the Redis connection string (URI), may be empty string.
+     * @param hostname     The hostname, with the brackets if it's an IPv6 literal, may be empty string.
+     * @param port         The port, may be empty string.
+     *
+     * @throws InvalidHostnameException When the brackets are invalid or it's an unbracketed IPv6 address.
      */
-    static std::string GetHostname(std::string hostnamePort);
+    static void SplitHostnamePort(std::string hostnamePort, std::string& hostname, std::string& port);
     /**
-     * @brief Gets the port from the hostname + port of the Redis connection string (URI).
+     * @brief Validates and decodes the hostname.
      *
-     * @param hostnamePort The hostname + port of the Redis connection string (URI).
-     * @return             Port of the Redis connection string (URI), may be empty string.
+     * @param hostname The hostname as SplitHostnamePort() gives it, may be empty string.
+     * @return         The hostname, may be empty string. A registered name is percent-decoded.
+     *                 An IPv6 literal is returned without the brackets, its zone ID after a
+     *                 plain %, like fe80::1%eth0.
+     *
+     * @throws InvalidHostnameException When the hostname isn't a valid registered name or
+     *                                  bracketed IPv6 literal.
+     */
+    static std::string ParseHostname(std::string hostname);
+    /**
+     * @brief Checks whether a string is an IPv6 address (without brackets and zone ID).
      */
-    static std::string GetPort(std::string hostnamePort);
+    static bool IsIpv6Address(std::string address);
+    /**
+     * @brief Converts the port to a number.
+     *
+     * @param port Port of the Redis connection string (URI), may be empty string.
+     * @return     The port, REDIS_NO_PORT if it's empty string.
+     *
+     * @throws InvalidPortException When the port isn't a number between 1 and 65535.
+     */
+    static uint16_t ParsePort(std::string port);
 
     /**
      * @brief Gets the path from a Redis connection string (URI) without scheme and userinfo.
@@ -158,6 +270,15 @@ private:
      * @return                 Path of the Redis connection string (URI), may be empty string.
      */
     static std::string GetPath(std::string hostnamePortPath);
+    /**
+     * @brief Converts the path to a DB index.
+     *
+     * @param path Path of the Redis connection string (URI), may be empty string.
+     * @return     The DB index, REDIS_NO_DB if the path is empty string.
+     *
+     * @throws InvalidDbIndexException When the path isn't a non-negative DB index.
+     */
+    static int ParseDb(std::string path);
 };
 
 }
@@ -0,0 +1,83 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace redisCliCs
+{
+
+/**
+ * @brief Represents a reply of the Redis server (RESP2).
+ */
+class RedisReply
+{
+public:
+    /// The RESP2 reply types.
+    enum Type
+    {
+        REPLY_STATUS,
+        REPLY_ERROR,
+        REPLY_INTEGER,
+        REPLY_STRING,
+        REPLY_ARRAY,
+        REPLY_NIL
+    };
+
+    RedisReply() : _type(REPLY_NIL),
+                   _integer(0),
+                   _string(""),
+                   _elements() {}
+
+    Type GetType() const { return _type; }
+    void SetType(Type type) { _type = type; }
+
+    long long GetInteger() const { return _integer; }
+    void SetInteger(long long integer) { _integer = integer; }
+
+    /// The value of a status, error or bulk string reply.
+    const std::string& GetString() const { return _string; }
+    void SetString(const std::string& str) { _string = str; }
+
+    /// The elements of an array reply.
+    const std::vector<RedisReply>& GetElements() const { return _elements; }
+    std::vector<RedisReply>& GetElements() { return _elements; }
+
+    bool IsNil() const { return _type == REPLY_NIL; }
+    bool IsError() const { return _type == REPLY_ERROR; }
+
+private:
+    /// Type of the reply.
+    Type _type;
+    /// Value of an integer reply.
+    long long _integer;
+    /// Value of a status, error or bulk string reply.
+    std::string _string;
+    /// Elements of an array reply.
+    std::vector<RedisReply> _elements;
+};
+
+}
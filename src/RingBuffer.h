@@ -0,0 +1,84 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace redisCliCs
+{
+
+/**
+ * @brief A fixed size ring buffer which overwrites its oldest item when it's full.
+ *
+ * The items are stored inline, so pushing never allocates.
+ */
+template <typename T, std::size_t N>
+class RingBuffer
+{
+public:
+    RingBuffer() : _items(), _next(0), _size(0) {}
+
+    /**
+     * @brief Adds an item, overwrites the oldest one if the buffer is full.
+     */
+    void Push(const T& item)
+    {
+        _items[_next] = item;
+        _next = (_next + 1) % N;
+        if (_size < N)
+            ++_size;
+    }
+
+    void Clear()
+    {
+        _next = 0;
+        _size = 0;
+    }
+
+    std::size_t Size() const { return _size; }
+    bool Empty() const { return !_size; }
+    static std::size_t Capacity() { return N; }
+
+    /**
+     * @brief Gets an item by its age.
+     *
+     * @param age 0 is the newest item, Size() - 1 is the oldest one.
+     */
+    const T& Newest(std::size_t age = 0) const { return _items[(_next + N - 1 - age) % N]; }
+    /**
+     * @brief Gets the oldest item.
+     */
+    const T& Oldest() const { return Newest(_size - 1); }
+
+private:
+    /// The items.
+    T _items[N];
+    /// Index of the slot which is written by the next push.
+    std::size_t _next;
+    /// Number of the items.
+    std::size_t _size;
+};
+
+}
@@ -0,0 +1,212 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief Tests for redisCliCs::BigKeysAnalyzer.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include "BigKeysAnalyzer.h"
+
+namespace redisCliCs
+{
+
+TEST(BigKeysAnalyzer, IsSampledAll) {
+    EXPECT_TRUE(BigKeysAnalyzer::IsSampled("foo", 1.0));
+    EXPECT_TRUE(BigKeysAnalyzer::IsSampled("", 1.0));
+}
+
+TEST(BigKeysAnalyzer, IsSampledDeterministic) {
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::ostringstream key;
+        key << "user:" << i;
+        EXPECT_EQ(BigKeysAnalyzer::IsSampled(key.str(), 0.3), BigKeysAnalyzer::IsSampled(key.str(), 0.3));
+        // A key sampled at a lower rate is sampled at a higher one too.
+        if (BigKeysAnalyzer::IsSampled(key.str(), 0.1))
+        {
+            EXPECT_TRUE(BigKeysAnalyzer::IsSampled(key.str(), 0.3));
+        }
+    }
+}
+
+TEST(BigKeysAnalyzer, IsSampledRate) {
+    const int keys = 100000;
+    double rates[] = { 0.01, 0.1, 0.5 };
+    for (std::size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r)
+    {
+        int sampled = 0;
+        for (int i = 0; i < keys; ++i)
+        {
+            std::ostringstream key;
+            key << "session:" << i;
+            if (BigKeysAnalyzer::IsSampled(key.str(), rates[r]))
+                ++sampled;
+        }
+        EXPECT_NEAR(rates[r], static_cast<double>(sampled) / keys, 0.01);
+    }
+}
+
+TEST(BigKeysAnalyzer, FormatBytes) {
+    EXPECT_EQ("0B", BigKeysAnalyzer::FormatBytes(0));
+    EXPECT_EQ("1023B", BigKeysAnalyzer::FormatBytes(1023));
+    EXPECT_EQ("1.0K", BigKeysAnalyzer::FormatBytes(1024));
+    EXPECT_EQ("1.5K", BigKeysAnalyzer::FormatBytes(1536));
+    EXPECT_EQ("1.0M", BigKeysAnalyzer::FormatBytes(1024 * 1024));
+    EXPECT_EQ("4.8M", BigKeysAnalyzer::FormatBytes(5000000));
+    EXPECT_EQ("1.0T", BigKeysAnalyzer::FormatBytes(1ULL << 40));
+    // Stays in the biggest unit.
+    EXPECT_EQ("8192.0P", BigKeysAnalyzer::FormatBytes(1ULL << 63));
+}
+
+TEST(BigKeysAnalyzer, FormatKey) {
+    EXPECT_EQ("\"\"", BigKeysAnalyzer::FormatKey(""));
+    EXPECT_EQ("\"user:1 name\"", BigKeysAnalyzer::FormatKey("user:1 name"));
+    EXPECT_EQ("\"bin\\nkey\"", BigKeysAnalyzer::FormatKey("bin\nkey"));
+    EXPECT_EQ("\"a\\\"b\\\\c\"", BigKeysAnalyzer::FormatKey("a\"b\\c"));
+    EXPECT_EQ("\"\\r\\t\\a\\b\"", BigKeysAnalyzer::FormatKey("\r\t\a\b"));
+    EXPECT_EQ("\"\\x00\\x1b\\x7f\\xff\"", BigKeysAnalyzer::FormatKey(std::string("\0\x1b\x7f\xff", 4)));
+}
+
+TEST(BigKeysAnalyzer, ParseDbIndexes) {
+    std::string info = "# Keyspace\r\n"
+                       "db0:keys=12,expires=0,avg_ttl=0\r\n"
+                       "db3:keys=1,expires=1,avg_ttl=1000\r\n"
+                       "db15:keys=7,expires=0,avg_ttl=0\r\n";
+    std::vector<int> dbs = BigKeysAnalyzer::ParseDbIndexes(info);
+    ASSERT_EQ(3u, dbs.size());
+    EXPECT_EQ(0, dbs[0]);
+    EXPECT_EQ(3, dbs[1]);
+    EXPECT_EQ(15, dbs[2]);
+    // No keys at all.
+    EXPECT_TRUE(BigKeysAnalyzer::ParseDbIndexes("# Keyspace\r\n").empty());
+    EXPECT_TRUE(BigKeysAnalyzer::ParseDbIndexes("").empty());
+}
+
+TEST(BigKeysAnalyzer, GetChunk) {
+    std::size_t begin, end;
+    // Equal chunks.
+    BigKeysAnalyzer::GetChunk(8, 4, 0, begin, end);
+    EXPECT_EQ(0u, begin);
+    EXPECT_EQ(2u, end);
+    BigKeysAnalyzer::GetChunk(8, 4, 3, begin, end);
+    EXPECT_EQ(6u, begin);
+    EXPECT_EQ(8u, end);
+    // The last chunk is shorter.
+    BigKeysAnalyzer::GetChunk(10, 4, 3, begin, end);
+    EXPECT_EQ(9u, begin);
+    EXPECT_EQ(10u, end);
+    // Fewer keys than workers, every key goes to a different worker and the rest get nothing.
+    for (std::size_t w = 0; w < 4; ++w)
+    {
+        BigKeysAnalyzer::GetChunk(2, 4, w, begin, end);
+        EXPECT_EQ(std::min<std::size_t>(w, 2), begin);
+        EXPECT_EQ(std::min<std::size_t>(w + 1, 2), end);
+    }
+}
+
+TEST(BigKeysAnalyzer, AddKey) {
+    BigKeysStats stats(10, "", 10);
+    RedisReply type;
+    type.SetType(RedisReply::REPLY_STATUS);
+    type.SetString("hash");
+    RedisReply usage;
+    usage.SetType(RedisReply::REPLY_INTEGER);
+    usage.SetInteger(100);
+    EXPECT_TRUE(BigKeysAnalyzer::AddKey("foo", type, usage, stats));
+
+    // Deleted between SCAN and TYPE.
+    RedisReply none;
+    none.SetType(RedisReply::REPLY_STATUS);
+    none.SetString("none");
+    EXPECT_FALSE(BigKeysAnalyzer::AddKey("bar", none, usage, stats));
+    // Deleted between TYPE and MEMORY USAGE.
+    EXPECT_FALSE(BigKeysAnalyzer::AddKey("baz", type, RedisReply(), stats));
+
+    EXPECT_EQ(1u, stats.GetKeyCount());
+    EXPECT_EQ(100u, stats.GetTotalBytes());
+
+    RedisReply error;
+    error.SetType(RedisReply::REPLY_ERROR);
+    error.SetString("ERR unknown command");
+    EXPECT_THROW(BigKeysAnalyzer::AddKey("foo", type, error, stats), RedisConnection::ReplyErrorException);
+    EXPECT_THROW(BigKeysAnalyzer::AddKey("foo", error, usage, stats), RedisConnection::ReplyErrorException);
+}
+
+TEST(BigKeysAnalyzer, Report) {
+    BigKeysStats stats(2, ":", 2);
+    stats.Add("user:1", "string", 100);
+    stats.Add("user:2", "string", 3000);
+    stats.Add("user:3", "string", 0);
+    stats.Add("bin\nkey", "hash", 70000);
+    stats.Add("q:x", "list", 5);
+    stats.Add("plain", "string", 1);
+
+    std::ostringstream out;
+    BigKeysAnalyzer::Report(3, stats, 10, 0.5, out);
+    EXPECT_EQ("# DB 3\n"
+              "Scanned keys: 10, analyzed keys: 6, memory usage: 71.4K\n"
+              "Sample rate: 0.5 (the counts and the memory usage cover only the sampled keys)\n"
+              "\n"
+              "## string: 4 keys, 3.0K total, 775B average\n"
+              "Biggest keys:\n"
+              "    1)     2.9K  \"user:2\"\n"
+              "    2)     100B  \"user:1\"\n"
+              "Size histogram:\n"
+              "  [0B, 2B)                   2\n"
+              "  [64B, 128B)                1\n"
+              "  [2.0K, 4.0K)               1\n"
+              "\n"
+              "## list: 1 keys, 5B total, 5B average\n"
+              "Biggest keys:\n"
+              "    1)       5B  \"q:x\"\n"
+              "Size histogram:\n"
+              "  [4B, 8B)                   1\n"
+              "\n"
+              "## hash: 1 keys, 68.4K total, 68.4K average\n"
+              "Biggest keys:\n"
+              "    1)    68.4K  \"bin\\nkey\"\n"
+              "Size histogram:\n"
+              "  [64.0K, 128.0K)            1\n"
+              "\n"
+              "## Key prefixes\n"
+              "     68.4K           3 keys  (other)\n"
+              "      3.0K           3 keys  \"user:*\"\n"
+              "\n", out.str());
+}
+
+TEST(BigKeysAnalyzer, ReportAllKeys) {
+    BigKeysStats stats(10, "", 10);
+    std::ostringstream out;
+    BigKeysAnalyzer::Report(0, stats, 0, 1.0, out);
+    // No sample rate line, no types.
+    EXPECT_EQ("# DB 0\nScanned keys: 0, analyzed keys: 0, memory usage: 0B\n\n", out.str());
+}
+
+}
@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief Tests for redisCliCs::BigKeysStats.
+ */
+
+#include <gtest/gtest.h>
+
+#include "BigKeysStats.h"
+
+namespace redisCliCs
+{
+
+TEST(BigKeysStats, GetKeyType) {
+    EXPECT_EQ(BigKeysStats::KEY_TYPE_STRING, BigKeysStats::GetKeyType("string"));
+    EXPECT_EQ(BigKeysStats::KEY_TYPE_ZSET, BigKeysStats::GetKeyType("zset"));
+    EXPECT_EQ(BigKeysStats::KEY_TYPE_STREAM, BigKeysStats::GetKeyType("stream"));
+    EXPECT_EQ(BigKeysStats::KEY_TYPE_OTHER, BigKeysStats::GetKeyType("ReJSON-RL"));
+}
+
+TEST(BigKeysStats, GetHistogramBucket) {
+    EXPECT_EQ(0u, BigKeysStats::GetHistogramBucket(0));
+    EXPECT_EQ(0u, BigKeysStats::GetHistogramBucket(1));
+    EXPECT_EQ(1u, BigKeysStats::GetHistogramBucket(2));
+    EXPECT_EQ(1u, BigKeysStats::GetHistogramBucket(3));
+    EXPECT_EQ(10u, BigKeysStats::GetHistogramBucket(1024));
+    EXPECT_EQ(63u, BigKeysStats::GetHistogramBucket(~0ULL));
+}
+
+TEST(BigKeysStats, Add) {
+    BigKeysStats stats(10, "", 0);
+    stats.Add("a", "string", 100);
+    stats.Add("b", "string", 50);
+    stats.Add("c", "hash", 1000);
+
+    EXPECT_EQ(3u, stats.GetKeyCount());
+    EXPECT_EQ(1150u, stats.GetTotalBytes());
+    EXPECT_EQ(2u, stats.GetTypeStats(BigKeysStats::KEY_TYPE_STRING).count);
+    EXPECT_EQ(150u, stats.GetTypeStats(BigKeysStats::KEY_TYPE_STRING).totalBytes);
+    EXPECT_EQ(1u, stats.GetTypeStats(BigKeysStats::KEY_TYPE_STRING).histogram[6]);
+    EXPECT_EQ(1u, stats.GetTypeStats(BigKeysStats::KEY_TYPE_STRING).histogram[5]);
+    EXPECT_EQ(0u, stats.GetTypeStats(BigKeysStats::KEY_TYPE_LIST).count);
+    EXPECT_TRUE(stats.GetPrefixStats().empty());
+}
+
+TEST(BigKeysStats, GetTopKeys) {
+    BigKeysStats stats(3, "", 0);
+    unsigned long long sizes[] = { 5, 80, 1, 40, 90, 20, 70 };
+    for (std::size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+        stats.Add(std::string(1, 'a' + i), "list", sizes[i]);
+
+    std::vector<BigKey> top = stats.GetTopKeys(BigKeysStats::KEY_TYPE_LIST);
+    ASSERT_EQ(3u, top.size());
+    EXPECT_EQ("e", top[0].name);
+    EXPECT_EQ(90u, top[0].bytes);
+    EXPECT_EQ("b", top[1].name);
+    EXPECT_EQ(80u, top[1].bytes);
+    EXPECT_EQ("g", top[2].name);
+    EXPECT_EQ(70u, top[2].bytes);
+    EXPECT_EQ(7u, stats.GetTypeStats(BigKeysStats::KEY_TYPE_LIST).count);
+}
+
+TEST(BigKeysStats, GetPrefixStats) {
+    BigKeysStats stats(0, ":", 3);
+    stats.Add("user:1", "hash", 10);
+    stats.Add("user:2", "hash", 20);
+    stats.Add("session", "string", 5);
+    // The group limit is reached, so these are collected in one group.
+    stats.Add("cache:1", "string", 1);
+    stats.Add("lock:1", "string", 2);
+    stats.Add("user:3", "hash", 30);
+
+    const std::map<std::string, BigKeysPrefixStats>& prefixes = stats.GetPrefixStats();
+    ASSERT_EQ(3u, prefixes.size());
+    EXPECT_EQ(3u, prefixes.find("user:*")->second.count);
+    EXPECT_EQ(60u, prefixes.find("user:*")->second.totalBytes);
+    EXPECT_EQ(1u, prefixes.find(BIG_KEYS_NO_PREFIX)->second.count);
+    EXPECT_EQ(2u, prefixes.find(BIG_KEYS_OTHER_PREFIX)->second.count);
+    EXPECT_EQ(3u, prefixes.find(BIG_KEYS_OTHER_PREFIX)->second.totalBytes);
+    EXPECT_TRUE(stats.GetTopKeys(BigKeysStats::KEY_TYPE_HASH).empty());
+}
+
+}
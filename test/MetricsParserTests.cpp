@@ -0,0 +1,143 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief Tests for redisCliCs::MetricsParser and redisCliCs::MetricsRates.
+ */
+
+#include <gtest/gtest.h>
+
+#include "MetricsParser.h"
+
+namespace redisCliCs
+{
+
+static const char* INFO =
+    "# Clients\r\n"
+    "connected_clients:12\r\n"
+    "blocked_clients:0\r\n"
+    "\r\n"
+    "# Memory\r\n"
+    "used_memory:1048576\r\n"
+    "used_memory_human:1.00M\r\n"
+    "mem_fragmentation_ratio:1.25\r\n"
+    "\r\n"
+    "# Stats\r\n"
+    "total_commands_processed:1000\r\n"
+    "keyspace_hits:90\r\n"
+    "keyspace_misses:10\r\n"
+    "evicted_keys:5\r\n"
+    "\r\n"
+    "# Commandstats\r\n"
+    "cmdstat_get:calls=60,usec=120,usec_per_call=2.00,rejected_calls=0,failed_calls=0\r\n"
+    "cmdstat_set:calls=40,usec=200,usec_per_call=5.00\r\n"
+    "\r\n"
+    "# Keyspace\r\n"
+    "db0:keys=100,expires=2,avg_ttl=0\r\n"
+    "db5:keys=20,expires=0,avg_ttl=0\r\n";
+
+TEST(MetricsParser, ParseInfo) {
+    MetricsSample sample;
+    MetricsParser::ParseInfo(INFO, sample);
+    EXPECT_DOUBLE_EQ(12, sample.values[METRIC_CONNECTED_CLIENTS]);
+    EXPECT_DOUBLE_EQ(0, sample.values[METRIC_BLOCKED_CLIENTS]);
+    EXPECT_DOUBLE_EQ(1048576, sample.values[METRIC_USED_MEMORY]);
+    EXPECT_DOUBLE_EQ(1.25, sample.values[METRIC_MEM_FRAGMENTATION_RATIO]);
+    EXPECT_DOUBLE_EQ(1000, sample.values[METRIC_TOTAL_COMMANDS_PROCESSED]);
+    EXPECT_DOUBLE_EQ(90, sample.values[METRIC_KEYSPACE_HITS]);
+    EXPECT_DOUBLE_EQ(10, sample.values[METRIC_KEYSPACE_MISSES]);
+    EXPECT_DOUBLE_EQ(5, sample.values[METRIC_EVICTED_KEYS]);
+    EXPECT_DOUBLE_EQ(100, sample.values[METRIC_COMMAND_CALLS]);
+    EXPECT_DOUBLE_EQ(320, sample.values[METRIC_COMMAND_USEC]);
+    EXPECT_DOUBLE_EQ(120, sample.values[METRIC_KEYS]);
+    // Not in the reply.
+    EXPECT_TRUE(sample.values[METRIC_EXPIRED_KEYS] != sample.values[METRIC_EXPIRED_KEYS]);
+    EXPECT_TRUE(sample.values[METRIC_LATENCY_LATEST_MS] != sample.values[METRIC_LATENCY_LATEST_MS]);
+}
+
+TEST(MetricsParser, ParseInfoEmptyKeyspace) {
+    MetricsSample sample;
+    MetricsParser::ParseInfo("# Stats\r\ntotal_commands_processed:1\r\n\r\n# Keyspace\r\n", sample);
+    EXPECT_DOUBLE_EQ(0, sample.values[METRIC_KEYS]);
+
+    // No keyspace section at all, so the keys are unknown.
+    MetricsSample noKeyspace;
+    MetricsParser::ParseInfo("# Stats\r\ntotal_commands_processed:1\r\n", noKeyspace);
+    EXPECT_TRUE(noKeyspace.values[METRIC_KEYS] != noKeyspace.values[METRIC_KEYS]);
+}
+
+TEST(MetricsParser, ParseLatencyLatest) {
+    RedisReply reply;
+    reply.SetType(RedisReply::REPLY_ARRAY);
+    MetricsSample sample;
+    MetricsParser::ParseLatencyLatest(reply, sample);
+    EXPECT_DOUBLE_EQ(0, sample.values[METRIC_LATENCY_LATEST_MS]);
+
+    long long latencies[] = { 15, 40 };
+    for (int i = 0; i < 2; ++i)
+    {
+        RedisReply event;
+        event.SetType(RedisReply::REPLY_ARRAY);
+        event.GetElements().resize(4);
+        event.GetElements()[2].SetType(RedisReply::REPLY_INTEGER);
+        event.GetElements()[2].SetInteger(latencies[i]);
+        reply.GetElements().push_back(event);
+    }
+    MetricsParser::ParseLatencyLatest(reply, sample);
+    EXPECT_DOUBLE_EQ(40, sample.values[METRIC_LATENCY_LATEST_MS]);
+}
+
+TEST(MetricsParser, ParseLatencyLatestError) {
+    RedisReply reply;
+    reply.SetType(RedisReply::REPLY_ERROR);
+    MetricsSample sample;
+    MetricsParser::ParseLatencyLatest(reply, sample);
+    EXPECT_TRUE(sample.values[METRIC_LATENCY_LATEST_MS] != sample.values[METRIC_LATENCY_LATEST_MS]);
+}
+
+TEST(MetricsRates, Compute) {
+    MetricsSample previous;
+    previous.timestamp = 100;
+    MetricsParser::ParseInfo(INFO, previous);
+
+    MetricsSample current;
+    current.timestamp = 102;
+    MetricsParser::ParseInfo("total_commands_processed:3000\r\n"
+                             "keyspace_hits:150\r\n"
+                             "keyspace_misses:30\r\n"
+                             "evicted_keys:1\r\n"
+                             "cmdstat_get:calls=300,usec=1120\r\n", current);
+
+    MetricsRates rates = MetricsRates::Compute(previous, current);
+    EXPECT_DOUBLE_EQ(1000, rates.opsPerSec);
+    EXPECT_DOUBLE_EQ(0.75, rates.hitRatio);
+    EXPECT_DOUBLE_EQ(4, rates.usecPerCall);
+    // The counter was reset (server restart).
+    EXPECT_TRUE(rates.evictionsPerSec != rates.evictionsPerSec);
+    // Missing from both samples.
+    EXPECT_TRUE(rates.expirationsPerSec != rates.expirationsPerSec);
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief Tests for redisCliCs::MetricsSampler.
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "MetricsSampler.h"
+#include "RedisConnectionStringParser.h"
+
+namespace redisCliCs
+{
+
+TEST(MetricsSampler, GetNextTick) {
+    // On schedule.
+    EXPECT_EQ(1u, MetricsSampler::GetNextTick(100, 0.5, 0, 100.2));
+    EXPECT_EQ(5u, MetricsSampler::GetNextTick(100, 0.5, 4, 102.1));
+    // The next tick is just passed, it's still taken.
+    EXPECT_EQ(5u, MetricsSampler::GetNextTick(100, 0.5, 4, 102.6));
+    // The next tick passed more than half an interval ago.
+    EXPECT_EQ(6u, MetricsSampler::GetNextTick(100, 0.5, 4, 102.8));
+    // A long stall skips all the missed ticks.
+    EXPECT_EQ(41u, MetricsSampler::GetNextTick(100, 0.5, 4, 120.3));
+}
+
+TEST(MetricsSampler, SameServerSampledOnce) {
+    std::vector<RedisConnectionString> endpoints;
+    endpoints.push_back(RedisConnectionStringParser::Parse("redis://:foo@foobar.com:6379/0"));
+    // Differ only in the path or the password.
+    endpoints.push_back(RedisConnectionStringParser::Parse("redis://:foo@foobar.com:6379/3"));
+    endpoints.push_back(RedisConnectionStringParser::Parse("redis://:bar@FooBar.com"));
+    EXPECT_EQ(1u, MetricsSampler(endpoints, MetricsOptions()).GetEndpointCount());
+
+    // Different port.
+    endpoints.push_back(RedisConnectionStringParser::Parse("redis://:foo@foobar.com:6380/0"));
+    EXPECT_EQ(2u, MetricsSampler(endpoints, MetricsOptions()).GetEndpointCount());
+}
+
+TEST(MetricsSampler, AddSample) {
+    MetricsHistory history;
+    MetricsSample sample;
+    sample.values[METRIC_TOTAL_COMMANDS_PROCESSED] = 100;
+    MetricsSampler::AddSample(history, sample);
+    sample.values[METRIC_TOTAL_COMMANDS_PROCESSED] = 200;
+    MetricsSampler::AddSample(history, sample);
+    EXPECT_EQ(2u, history.Size());
+    // Not reported, it's kept.
+    sample.values[METRIC_TOTAL_COMMANDS_PROCESSED] = std::numeric_limits<double>::quiet_NaN();
+    MetricsSampler::AddSample(history, sample);
+    EXPECT_EQ(3u, history.Size());
+
+    // The counters are reset, only the new sample is kept.
+    sample.values[METRIC_TOTAL_COMMANDS_PROCESSED] = 300;
+    MetricsSampler::AddSample(history, sample);
+    sample.values[METRIC_TOTAL_COMMANDS_PROCESSED] = 5;
+    MetricsSampler::AddSample(history, sample);
+    ASSERT_EQ(1u, history.Size());
+    EXPECT_EQ(5, history.Newest().values[METRIC_TOTAL_COMMANDS_PROCESSED]);
+
+    // A missing sample and the one after it.
+    MetricsSample missing;
+    missing.missing = true;
+    MetricsSampler::AddSample(history, missing);
+    EXPECT_EQ(1u, history.Size());
+    sample.values[METRIC_TOTAL_COMMANDS_PROCESSED] = 10;
+    MetricsSampler::AddSample(history, sample);
+    EXPECT_EQ(1u, history.Size());
+    EXPECT_FALSE(history.Newest().missing);
+}
+
+}
@@ -0,0 +1,276 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief Tests for redisCliCs::MetricsWriter.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cctype>
+#include <limits>
+#include <sstream>
+
+#include "MetricsParser.h"
+#include "MetricsWriter.h"
+
+namespace redisCliCs
+{
+
+/**
+ * @brief A minimal JSON validator, it's enough to check the writer's output.
+ */
+class JsonValidator
+{
+public:
+    /// Checks that the text is exactly one valid JSON value.
+    static bool IsValid(const std::string& text)
+    {
+        std::size_t pos = 0;
+        if (!Value(text, pos))
+            return false;
+        SkipSpaces(text, pos);
+        return pos == text.length();
+    }
+
+private:
+    static void SkipSpaces(const std::string& text, std::size_t& pos)
+    {
+        while (pos < text.length() && std::isspace(static_cast<unsigned char>(text[pos])))
+            ++pos;
+    }
+
+    static bool Literal(const std::string& text, std::size_t& pos, const std::string& literal)
+    {
+        if (text.compare(pos, literal.length(), literal))
+            return false;
+        pos += literal.length();
+        return true;
+    }
+
+    static bool String(const std::string& text, std::size_t& pos)
+    {
+        if (!Literal(text, pos, "\""))
+            return false;
+        while (pos < text.length() && text[pos] != '"')
+        {
+            if (static_cast<unsigned char>(text[pos]) < 0x20)
+                return false;
+            if (text[pos] == '\\')
+            {
+                ++pos;
+                if (pos >= text.length())
+                    return false;
+                if (text[pos] == 'u')
+                {
+                    for (int i = 0; i < 4; ++i)
+                        if (++pos >= text.length() || !std::isxdigit(static_cast<unsigned char>(text[pos])))
+                            return false;
+                }
+                else if (std::string("\"\\/bfnrt").find(text[pos]) == std::string::npos)
+                    return false;
+            }
+            ++pos;
+        }
+        return Literal(text, pos, "\"");
+    }
+
+    static bool Number(const std::string& text, std::size_t& pos)
+    {
+        std::size_t start = pos;
+        if (pos < text.length() && text[pos] == '-')
+            ++pos;
+        if (pos >= text.length() || !std::isdigit(static_cast<unsigned char>(text[pos])))
+            return false;
+        while (pos < text.length() && std::string("0123456789.eE+-").find(text[pos]) != std::string::npos)
+            ++pos;
+        return pos > start;
+    }
+
+    static bool Value(const std::string& text, std::size_t& pos)
+    {
+        SkipSpaces(text, pos);
+        if (pos >= text.length())
+            return false;
+        char c = text[pos];
+        if (c == '"')
+            return String(text, pos);
+        if (c == 't')
+            return Literal(text, pos, "true");
+        if (c == 'f')
+            return Literal(text, pos, "false");
+        if (c == 'n')
+            return Literal(text, pos, "null");
+        if (c == '[' || c == '{')
+        {
+            char close = c == '[' ? ']' : '}';
+            ++pos;
+            SkipSpaces(text, pos);
+            if (pos < text.length() && text[pos] == close)
+                return ++pos, true;
+            for (;;)
+            {
+                if (c == '{')
+                {
+                    SkipSpaces(text, pos);
+                    if (!String(text, pos))
+                        return false;
+                    SkipSpaces(text, pos);
+                    if (!Literal(text, pos, ":"))
+                        return false;
+                }
+                if (!Value(text, pos))
+                    return false;
+                SkipSpaces(text, pos);
+                if (pos < text.length() && text[pos] == ',')
+                {
+                    ++pos;
+                    continue;
+                }
+                return Literal(text, pos, std::string(1, close));
+            }
+        }
+        return Number(text, pos);
+    }
+};
+
+static MetricsSample MakeSample(double timestamp, double commands, double selfCommands)
+{
+    std::ostringstream info;
+    info << "total_commands_processed:" << commands << "\r\n"
+         << "keyspace_hits:" << commands / 2 << "\r\n"
+         << "keyspace_misses:" << commands / 2 << "\r\n"
+         << "used_memory:1048576\r\n"
+         << "# Keyspace\r\n";
+    MetricsSample sample;
+    sample.timestamp = timestamp;
+    sample.selfCommands = selfCommands;
+    MetricsParser::ParseInfo(info.str(), sample);
+    return sample;
+}
+
+TEST(MetricsWriter, WriteJsonNumber) {
+    std::ostringstream out;
+    MetricsWriter::WriteJsonNumber(out, std::numeric_limits<double>::quiet_NaN());
+    out << " ";
+    MetricsWriter::WriteJsonNumber(out, std::numeric_limits<double>::infinity());
+    out << " ";
+    MetricsWriter::WriteJsonNumber(out, 1792409016.125);
+    out << " ";
+    MetricsWriter::WriteJsonNumber(out, 0.5);
+    EXPECT_EQ("null null 1792409016.125 0.5", out.str());
+    // The precision of the stream is restored.
+    EXPECT_EQ(6, out.precision());
+}
+
+TEST(MetricsWriter, WriteJsonString) {
+    std::ostringstream out;
+    MetricsWriter::WriteJsonString(out, std::string("a\"b\\c\n\x01\x7f", 8));
+    EXPECT_EQ("\"a\\\"b\\\\c\\u000a\\u0001\x7f\"", out.str());
+    EXPECT_TRUE(JsonValidator::IsValid(out.str()));
+}
+
+TEST(MetricsWriter, WriteNdjsonFirstSample) {
+    MetricsHistory history;
+    history.Push(MakeSample(100, 1000, 0));
+
+    std::ostringstream out;
+    MetricsWriter::WriteNdjson(out, "[::1]:6379", history);
+    std::string line = out.str();
+    ASSERT_EQ('\n', line[line.length() - 1]);
+    EXPECT_TRUE(JsonValidator::IsValid(line.substr(0, line.length() - 1)));
+    EXPECT_NE(std::string::npos, line.find("\"endpoint\":\"[::1]:6379\""));
+    EXPECT_NE(std::string::npos, line.find("\"up\":true"));
+    EXPECT_NE(std::string::npos, line.find("\"used_memory\":1048576"));
+    EXPECT_NE(std::string::npos, line.find("\"keys\":0"));
+    EXPECT_NE(std::string::npos, line.find("\"connected_clients\":null"));
+    EXPECT_NE(std::string::npos, line.find("\"rates\":null,\"window_seconds\":null,\"window_rates\":null"));
+}
+
+TEST(MetricsWriter, WriteNdjsonRates) {
+    MetricsHistory history;
+    history.Push(MakeSample(100, 1000, 0));
+    history.Push(MakeSample(101, 1502, 2));
+    history.Push(MakeSample(102, 3004, 4));
+
+    std::ostringstream out;
+    MetricsWriter::WriteNdjson(out, "localhost:6379", history);
+    std::string line = out.str();
+    EXPECT_TRUE(JsonValidator::IsValid(line.substr(0, line.length() - 1)));
+    // The sampler's own 2 commands per sample are subtracted.
+    EXPECT_NE(std::string::npos, line.find("\"rates\":{\"ops_per_sec\":1500,\"hit_ratio\":0.5,"));
+    EXPECT_NE(std::string::npos, line.find("\"window_seconds\":2,\"window_rates\":{\"ops_per_sec\":1000,"));
+    EXPECT_NE(std::string::npos, line.find("\"evictions_per_sec\":null"));
+}
+
+TEST(MetricsWriter, WriteNdjsonMissing) {
+    MetricsHistory history;
+    MetricsSample sample;
+    sample.timestamp = 100;
+    sample.missing = true;
+    history.Push(sample);
+
+    std::ostringstream out;
+    MetricsWriter::WriteNdjson(out, "localhost:6379", history);
+    std::string line = out.str();
+    EXPECT_TRUE(JsonValidator::IsValid(line.substr(0, line.length() - 1)));
+    EXPECT_NE(std::string::npos, line.find("\"up\":false"));
+    EXPECT_NE(std::string::npos, line.find("\"total_commands_processed\":null"));
+}
+
+TEST(MetricsWriter, WriteTable) {
+    MetricsHistory history;
+    history.Push(MakeSample(100, 1000, 0));
+    history.Push(MakeSample(101, 1502, 2));
+
+    std::ostringstream header;
+    MetricsWriter::WriteTableHeader(header, true);
+    std::ostringstream row;
+    MetricsWriter::WriteTableRow(row, "localhost:6379", history);
+
+    // The columns are aligned.
+    EXPECT_EQ(header.str().find("endpoint"), row.str().find("localhost:6379"));
+    EXPECT_EQ(header.str().find("ops/s") + 5, row.str().find(" 500 ") + 4);
+    EXPECT_NE(std::string::npos, row.str().find(" 50.0 "));
+    EXPECT_NE(std::string::npos, row.str().find(" 1.0 "));
+    // The missing values are dashes.
+    EXPECT_NE(std::string::npos, row.str().find(" - "));
+    EXPECT_EQ(std::string::npos, row.str().find("nan"));
+}
+
+TEST(MetricsWriter, WriteTableMissing) {
+    MetricsHistory history;
+    MetricsSample sample;
+    sample.timestamp = 100;
+    sample.missing = true;
+    history.Push(sample);
+
+    std::ostringstream row;
+    MetricsWriter::WriteTableRow(row, "", history);
+    EXPECT_NE(std::string::npos, row.str().find("(no reply)"));
+    EXPECT_EQ(std::string::npos, row.str().find("nan"));
+}
+
+}
@@ -0,0 +1,75 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015 David Vas <anuka|Anubisss>, http://anuka.me/
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief Tests for redisCliCs::RingBuffer.
+ */
+
+#include <gtest/gtest.h>
+
+#include "RingBuffer.h"
+
+namespace redisCliCs
+{
+
+TEST(RingBuffer, Empty) {
+    RingBuffer<int, 3> buffer;
+    EXPECT_TRUE(buffer.Empty());
+    EXPECT_EQ(0u, buffer.Size());
+    EXPECT_EQ(3u, buffer.Capacity());
+}
+
+TEST(RingBuffer, Push) {
+    RingBuffer<int, 3> buffer;
+    buffer.Push(1);
+    buffer.Push(2);
+    EXPECT_EQ(2u, buffer.Size());
+    EXPECT_EQ(2, buffer.Newest());
+    EXPECT_EQ(1, buffer.Newest(1));
+    EXPECT_EQ(1, buffer.Oldest());
+}
+
+TEST(RingBuffer, Overwrite) {
+    RingBuffer<int, 3> buffer;
+    for (int i = 1; i <= 5; ++i)
+        buffer.Push(i);
+    EXPECT_EQ(3u, buffer.Size());
+    EXPECT_EQ(5, buffer.Newest());
+    EXPECT_EQ(4, buffer.Newest(1));
+    EXPECT_EQ(3, buffer.Newest(2));
+    EXPECT_EQ(3, buffer.Oldest());
+}
+
+TEST(RingBuffer, Clear) {
+    RingBuffer<int, 3> buffer;
+    buffer.Push(1);
+    buffer.Clear();
+    EXPECT_TRUE(buffer.Empty());
+    buffer.Push(2);
+    EXPECT_EQ(2, buffer.Oldest());
+    EXPECT_EQ(2, buffer.Newest());
+}
+
+}